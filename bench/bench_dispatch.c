@@ -0,0 +1,66 @@
+// Interpreter throughput: one instruction per cycle through execute_instruction
+// versus long runs through execute_instruction_run. Built once per dispatch mode
+// by "make bench"; the simulator's own chatter goes to /dev/null.
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "scheduler_api.h"
+#include "interpreter.h"
+
+#define BENCH_PROGRAM "bench_loop.txt"
+
+static double elapsed_seconds(const struct timespec* start) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// A counting loop of four compute instructions per iteration; returns the instruction count
+static long long write_program(long long iterations) {
+    FILE* file = fopen(BENCH_PROGRAM, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to write %s\n", BENCH_PROGRAM);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(file, "assign i 0\nassign sum 0\nloop:\nadd sum sum i\nadd i i 1\n");
+    fprintf(file, "lt more i %lld\njnz more loop\nprint sum\n", iterations);
+    fclose(file);
+    return 2 + 4 * iterations + 1;
+}
+
+// Instructions per second for one run of the loop at the given per-cycle budget
+static double measure(long long iterations, int per_cycle, int* cycles) {
+    reset_scheduler();
+    api_set_instructions_per_cycle(per_cycle);
+    long long instructions = write_program(iterations);
+    if (load_process_from_file(BENCH_PROGRAM, 0) < 0) {
+        fprintf(stderr, "Failed to load %s\n", BENCH_PROGRAM);
+        exit(EXIT_FAILURE);
+    }
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    do {
+        step_execution();
+    } while (get_total_processes() > 0 || has_pending_processes());
+    double seconds = elapsed_seconds(&start);
+    *cycles = get_clock_cycle();
+    return instructions / seconds;
+}
+
+int main(int argc, char** argv) {
+    long long iterations = argc > 1 ? atoll(argv[1]) : 20000;
+    int per_cycle = argc > 2 ? atoi(argv[2]) : 1000;
+    if (!freopen("/dev/null", "w", stdout)) return EXIT_FAILURE;
+
+    api_init_scheduler(FCFS, 1);
+    int slow_cycles, fast_cycles;
+    double slow = measure(iterations, 1, &slow_cycles);
+    double fast = measure(iterations * 50, per_cycle, &fast_cycles);
+    remove(BENCH_PROGRAM);
+
+    fprintf(stderr, "[BENCH] %s dispatch\n", interpreter_dispatch_mode());
+    fprintf(stderr, "  1 instruction/cycle:   %12.0f instructions/s (%d cycles)\n", slow, slow_cycles);
+    fprintf(stderr, "  %d instructions/cycle: %12.0f instructions/s (%d cycles), %.1fx\n",
+        per_cycle, fast, fast_cycles, fast / slow);
+    return 0;
+}
@@ -26,6 +26,9 @@ lib.api_init_scheduler.restype = None
 lib.load_process_from_file.argtypes = [ctypes.c_char_p, ctypes.c_int]
 lib.load_process_from_file.restype = None
 
+lib.load_manifest.argtypes = [ctypes.c_char_p]
+lib.load_manifest.restype = ctypes.c_char_p
+
 lib.step_execution.restype = None
 lib.get_clock_cycle.restype = ctypes.c_int
 lib.get_latest_log.restype = ctypes.c_char_p
@@ -39,17 +42,10 @@ print("➡️ Initializing Scheduler with MLFQ...")
 lib.api_init_scheduler(2, 2)
 
 # Load programs
-programs = [
-    ("program3.txt", 0),
-    ("program1.txt", 1),
-    ("program2.txt", 3)
-]
-
 base_dir = os.path.abspath(os.path.join(current_dir, '..'))
-for fname, arrival in programs:
-    path = os.path.join(base_dir, fname)
-    print(f"📥 Loading {fname} (Arrival: {arrival})")
-    lib.load_process_from_file(ctypes.c_char_p(path.encode()), ctypes.c_int(arrival))
+manifest = os.path.join(base_dir, 'demo.manifest')
+print(f"📥 Loading {manifest}")
+print(lib.load_manifest(manifest.encode()).decode())
 
 print("✅ All processes loaded.\n")
 
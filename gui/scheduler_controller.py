@@ -9,11 +9,21 @@ import os
 import logging
 import platform
 from PyQt5.QtCore import QTimer
+from PyQt5.QtGui import QGuiApplication
 from PyQt5.QtWidgets import QApplication, QTableWidgetItem, QMessageBox, QInputDialog
 from scheduler_ui import SchedulerUI
 from PyQt5.QtWidgets import QFileDialog
 
 
+# Backend event types (EventType in events.h) the tables are driven by
+EVENT_STATE = 0
+EVENT_QUEUE = 1
+EVENT_MEMORY = 2
+EVENT_CLOCK = 4
+EVENT_RESET = 5
+EVENT_OVERFLOW = 6
+TABLE_EVENTS = (1 << EVENT_STATE) | (1 << EVENT_QUEUE) | (1 << EVENT_MEMORY) | (1 << EVENT_CLOCK) | (1 << EVENT_RESET) | (1 << EVENT_OVERFLOW)
+
 
 class SchedulerController:
     
@@ -65,9 +75,18 @@ class SchedulerController:
 
         self.lib.load_process_from_file.argtypes = [ctypes.c_char_p, ctypes.c_int]
         self.lib.load_process_from_file.restype = None
+        self.lib.load_manifest.argtypes = [ctypes.c_char_p]
+        self.lib.load_manifest.restype = ctypes.c_char_p
         
         self.lib.get_latest_log.restype = ctypes.c_char_p
 
+        # Change events, so the tables only touch what changed
+        self.lib.api_set_event_queue.argtypes = [ctypes.c_uint]
+        self.lib.api_set_event_queue.restype = None
+        self.lib.get_events.argtypes = [ctypes.c_int]
+        self.lib.get_events.restype = ctypes.c_char_p
+        self.lib.api_set_event_queue(TABLE_EVENTS)
+
         #  setup for set_gui_input
         self.lib.is_waiting_for_gui_input.restype = ctypes.c_int
         self.lib.set_gui_input.argtypes = [ctypes.c_char_p]
@@ -87,16 +106,20 @@ class SchedulerController:
         self.timer = QTimer()
         self.timer.timeout.connect(self.step_execution)
 
+        # Table redraws are coalesced to one per display frame
+        refresh_rate = QGuiApplication.primaryScreen().refreshRate() if QGuiApplication.primaryScreen() else 60
+        self.redraw_timer = QTimer()
+        self.redraw_timer.setSingleShot(True)
+        self.redraw_timer.setInterval(max(1, int(1000 / (refresh_rate or 60))))
+        self.redraw_timer.timeout.connect(self.redraw_tables)
+
         # Set up logging
         logging.basicConfig(level=logging.INFO, filename='scheduler_gui.log')
         self.last_seen_log = ""
         
         # Clear logs + tables
         self.ui.execution_log.clear()
-        self.ui.process_table.setRowCount(0)
-        self.ui.queue_table.setRowCount(0)
-        self.ui.memory_table.setRowCount(0)
-        self.ui.resource_table.setRowCount(0)
+        self.clear_tables()
 
     def start_simulation(self):
         if self.lib.get_total_processes() == 0 and self.lib.has_pending_processes() == 0:
@@ -115,6 +138,8 @@ class SchedulerController:
             algo = 0
         elif algo_text == "Round Robin":
             algo = 1
+        elif algo_text == "CFS":
+            algo = 3
         else:
             algo = 2        # MLFQ
 
@@ -160,10 +185,7 @@ class SchedulerController:
         # Clear logs + tables
         self.ui.execution_log.clear()
         self.ui.event_log.clear()
-        self.ui.process_table.setRowCount(0)
-        self.ui.queue_table.setRowCount(0)
-        self.ui.memory_table.setRowCount(0)
-        self.ui.resource_table.setRowCount(0)
+        self.clear_tables()
 
         self.ui.append_execution_log("[INFO] Resetting simulation.", "-", "-")
         self.ui.append_event_log("Reset", "-", "Scheduler reset + PID counter reset to 1.")
@@ -216,6 +238,8 @@ class SchedulerController:
                     algo = 0
                 elif algo_text == "Round Robin":
                     algo = 1
+                elif algo_text == "CFS":
+                    algo = 3
                 else:
                     algo = 2  # MLFQ
 
@@ -229,6 +253,8 @@ class SchedulerController:
             try:
                 # Load process to backend
                 self.lib.load_process_from_file(ctypes.c_char_p(path.encode()), ctypes.c_int(arrival))
+                # Pending processes raise no events until they arrive
+                self.rows_dirty = True
                 self.update_status()
                 self.has_loaded_process = True
                 self.no_process_warning_shown = False
@@ -261,26 +287,9 @@ class SchedulerController:
             self.ui.lbl_clock.setText(f"Clock Cycle: {clock_cycle}")
             self.ui.lbl_algorithm.setText(f"Algorithm: {algorithm}")
 
-            process_list_str = self.lib.get_process_list().decode()
-            logging.info(f"Process List Raw: {process_list_str}")
-            self.update_table(self.ui.process_table, process_list_str)
-
-            queue_state_str = self.lib.get_queue_state().decode()
-            self.update_table(self.ui.queue_table, queue_state_str)
-
-            memory_state_str = self.lib.get_memory_state().decode()
-            rows = memory_state_str.strip().split('\n')
-            self.ui.memory_table.setRowCount(len(rows))
-            for idx, row in enumerate(rows):
-                self.ui.memory_table.setItem(idx, 0, QTableWidgetItem(row.strip()))
-
-            mutex_state_str = self.lib.get_mutex_state().decode()
-            rows = mutex_state_str.strip().split('\n')
-            self.ui.resource_table.setRowCount(len(rows))
-            for idx, row in enumerate(rows):
-                fields = row.split(',')
-                for col_idx, value in enumerate(fields):
-                    self.ui.resource_table.setItem(idx, col_idx, QTableWidgetItem(value))
+            self.collect_changes()
+            if not self.redraw_timer.isActive():
+                self.redraw_timer.start()
 
             if self.lib.is_waiting_for_gui_input() == 1:
                 self.ui.append_execution_log("Input Required", "-", "[GUI_INPUT] Backend is waiting for user input.")
@@ -318,17 +327,115 @@ class SchedulerController:
             logging.error(f"Failed to update status: {e}")
             QMessageBox.critical(self.ui, "Error", f"Failed to update status: {e}")
 
+    def clear_tables(self):
+        for table in (self.ui.process_table, self.ui.queue_table, self.ui.memory_table, self.ui.resource_table):
+            table.setRowCount(0)
+        self.row_keys = {}
+        self.rows_dirty = True
+        self.dirty_memory = set()
+        self.memory_dirty_all = True
+
+    def collect_changes(self):
+        # Drain the backend's change events; the buffer holds a bounded number per call
+        while True:
+            chunk = self.lib.get_events(0).decode()
+            if not chunk:
+                break
+            for line in chunk.splitlines():
+                fields = line.split(',')
+                if len(fields) < 5:
+                    continue
+                kind = fields[0]
+                if kind in ("state", "queue", "clock"):
+                    self.rows_dirty = True
+                elif kind == "memory":
+                    first, last = int(fields[2]), int(fields[3])
+                    self.dirty_memory.update(range(first, last + 1))
+                elif kind in ("reset", "overflow"):
+                    self.rows_dirty = True
+                    self.memory_dirty_all = True
+
+    def redraw_tables(self):
+        try:
+            if self.rows_dirty:
+                self.rows_dirty = False
+                process_list_str = self.lib.get_process_list().decode()
+                logging.info(f"Process List Raw: {process_list_str}")
+                self.update_table(self.ui.process_table, process_list_str)
+                self.update_table(self.ui.queue_table, self.lib.get_queue_state().decode())
+                self.update_table(self.ui.resource_table, self.lib.get_mutex_state().decode())
+
+            if self.memory_dirty_all or self.dirty_memory:
+                rows = self.lib.get_memory_state().decode().strip().split('\n')
+                table = self.ui.memory_table
+                table.setUpdatesEnabled(False)
+                if table.rowCount() != len(rows):
+                    table.setRowCount(len(rows))
+                    self.memory_dirty_all = True
+                # Words are rows by address; the usage summary is the last row and changes with any word
+                wanted = range(len(rows)) if self.memory_dirty_all else sorted(
+                    [idx for idx in self.dirty_memory if idx < len(rows)] + [len(rows) - 1])
+                for idx in wanted:
+                    self.set_cell(table, idx, 0, rows[idx].strip())
+                table.setUpdatesEnabled(True)
+                self.dirty_memory.clear()
+                self.memory_dirty_all = False
+        except Exception as e:
+            logging.error(f"Failed to redraw tables: {e}")
+            QMessageBox.critical(self.ui, "Error", f"Failed to redraw tables: {e}")
+
+    def set_cell(self, table, row, col, value):
+        item = table.item(row, col)
+        if item is None:
+            table.setItem(row, col, QTableWidgetItem(value))
+        elif item.text() != value:
+            item.setText(value)
+
     def update_table(self, table, data):
+        # Rows are keyed by their first field, so a tick only inserts, removes or
+        # edits the rows that changed instead of rebuilding the table
         try:
-            rows = data.strip().split('\n')
-            table.setRowCount(0)
-            for row in rows:
-                fields = row.split(',')
-                row_idx = table.rowCount()
-                table.insertRow(row_idx)
+            rows = [row.split(',') for row in data.strip().split('\n')] if data.strip() else []
+            seen = {}
+            keys = []
+            for fields in rows:
+                seen[fields[0]] = seen.get(fields[0], 0) + 1
+                keys.append((fields[0], seen[fields[0]]))
+
+            current = self.row_keys.get(id(table))
+            if current is None or len(current) != table.rowCount():
+                table.setRowCount(0)
+                current = []
+            table.setUpdatesEnabled(False)
+
+            wanted = set(keys)
+            for idx in range(len(current) - 1, -1, -1):
+                if current[idx] not in wanted:
+                    table.removeRow(idx)
+                    del current[idx]
+
+            for idx, key in enumerate(keys):
+                if idx < len(current) and current[idx] == key:
+                    continue
+                if key in current[idx:]:
+                    # Moved up, e.g. a queue rotating: take it out of its old place
+                    old = current.index(key, idx)
+                    table.removeRow(old)
+                    del current[old]
+                table.insertRow(idx)
+                current.insert(idx, key)
+
+            for idx, fields in enumerate(rows):
                 for col_idx, value in enumerate(fields):
-                    table.setItem(row_idx, col_idx, QTableWidgetItem(value))
+                    self.set_cell(table, idx, col_idx, value)
+                for col_idx in range(len(fields), table.columnCount()):
+                    if table.item(idx, col_idx) is not None:
+                        self.set_cell(table, idx, col_idx, "")
+
+            table.setUpdatesEnabled(True)
+            self.row_keys[id(table)] = current
         except Exception as e:
+            table.setUpdatesEnabled(True)
             logging.error(f"Failed to update table: {e}")
             QMessageBox.critical(self.ui, "Error", f"Failed to update table: {e}")
 
@@ -379,16 +486,17 @@ class SchedulerController:
             self.ui.append_execution_log("[INFO] Scheduler re‑initialized for scenario (MLFQ).", "-", "-")
         self.initialized = True
 
-        files = [
-            ("program3.txt", 0),
-            ("program1.txt", 1),
-            ("program2.txt", 3)
-        ]
-        for fname, arrival in files:
-            path = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', fname))
-            self.lib.load_process_from_file(ctypes.c_char_p(path.encode()), ctypes.c_int(arrival))
-            self.ui.append_execution_log("Add Process", "-", f"{fname} (Arrival: {arrival})")
+        manifest = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'demo.manifest'))
+        report = self.lib.load_manifest(manifest.encode()).decode()
+        fields = dict(line.split('=', 1) for line in report.splitlines() if '=' in line and not line.startswith('line '))
+        self.ui.append_execution_log("Add Process", "-",
+            f"demo.manifest: PIDs {fields.get('first_pid', '-')}-{fields.get('last_pid', '-')} "
+            f"({fields.get('loaded', '0')} loaded, {fields.get('failed', '0')} failed)")
+        for line in report.splitlines():
+            if line.startswith('line ') or line.startswith('error='):
+                self.ui.append_execution_log("Warning", "-", line)
         self.no_process_warning_shown = False
+        self.rows_dirty = True
         self.update_status()
 
 
@@ -61,16 +61,14 @@ class SchedulerUI(QMainWindow):
         # Resource Management Panel 
         resource_group = QGroupBox("Resource Management")
         resource_layout = QVBoxLayout()
-        self.resource_table = QTableWidget(3, 3)
+        self.resource_table = QTableWidget(3, 4)
         self.resource_table.setHorizontalHeaderLabels([
-            "Resource", "Held By", "Waiting"
+            "Resource", "Held By", "Waiting", "Available"
         ])
         self.resource_table.setColumnWidth(0, 200)
         self.resource_table.setColumnWidth(1, 100)
         self.resource_table.setColumnWidth(2, 100)
-        self.resource_table.setVerticalHeaderLabels([
-            "userInput", "userOutput", "file"
-        ])
+        self.resource_table.setColumnWidth(3, 100)
         self.resource_table.setFixedHeight(110)
         resource_layout.addWidget(self.resource_table)
         resource_group.setLayout(resource_layout)
@@ -80,7 +78,7 @@ class SchedulerUI(QMainWindow):
         control_group = QGroupBox("Scheduler Control")
         control_layout = QHBoxLayout()
         self.algo_combo = QComboBox()
-        self.algo_combo.addItems(["FCFS", "Round Robin", "MLFQ"])
+        self.algo_combo.addItems(["FCFS", "Round Robin", "MLFQ", "CFS"])
         self.quantum_spin = QSpinBox()
         self.quantum_spin.setRange(1, 100)
         self.quantum_spin.setValue(2)
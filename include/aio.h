@@ -0,0 +1,42 @@
+#ifndef AIO_H
+#define AIO_H
+
+#include <stdbool.h>
+#include "pcb.h"
+#include "scheduler.h"
+
+#define AIO_WORKERS 4
+#define AIO_DEFAULT_LATENCY 2   // simulated cycles between submission and completion
+
+typedef enum {
+    AIO_READ,
+    AIO_WRITE
+} AioOp;
+
+// One readFile/writeFile handed to the I/O threads
+typedef struct AioRequest {
+    AioOp op;
+    PCB* pcb;
+    int pid;
+    char* path;
+    char* data;          // write: contents; read: result, NULL if the file does not exist
+    bool ok;
+    bool done;           // a worker has finished the real I/O
+    int due_cycle;       // clock cycle at which the simulation sees the completion
+    struct AioRequest* next;       // in-flight or completed list
+    struct AioRequest* work_next;  // queue of requests no worker has picked up yet
+} AioRequest;
+
+void aio_set_enabled(bool enabled);
+bool aio_is_enabled();
+void aio_set_latency(int cycles);
+void aio_submit(PCB* pcb, AioOp op, const char* path, const char* data);
+AioRequest* aio_take_completion(PCB* pcb);
+void aio_free_request(AioRequest* request);
+int aio_deliver(Scheduler* scheduler);
+int aio_next_due();
+void aio_quiesce();
+void aio_after_fork();
+void aio_reset();
+
+#endif // AIO_H
@@ -0,0 +1,39 @@
+#ifndef CFS_H
+#define CFS_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+// Weight of a nice-0 process; vruntime advances at wall speed for it
+#define CFS_NICE_0_WEIGHT 1024
+#define CFS_MIN_NICE -20
+#define CFS_MAX_NICE 19
+
+// vruntime is kept in 1/1024ths of a clock cycle so heavy weights still advance
+#define CFS_VRUNTIME_SCALE 1024
+
+#define CFS_DEFAULT_MIN_GRANULARITY 1
+#define CFS_DEFAULT_TARGET_LATENCY 8
+
+// Red-black tree of runnable processes ordered by (vruntime, pid).
+// The nodes are embedded in the PCB, so enqueue/dequeue never allocate.
+typedef struct {
+    PCB* root;
+    PCB* leftmost;
+    int count;
+    long long total_weight;
+    long long min_vruntime;
+} CfsRunQueue;
+
+void cfs_init(CfsRunQueue* rq);
+void cfs_enqueue(CfsRunQueue* rq, PCB* pcb);
+void cfs_dequeue(CfsRunQueue* rq, PCB* pcb);
+PCB* cfs_pick_next(CfsRunQueue* rq);
+PCB* cfs_peek(const CfsRunQueue* rq);
+PCB* cfs_next(const PCB* pcb);
+bool cfs_is_empty(const CfsRunQueue* rq);
+int cfs_timeslice(const CfsRunQueue* rq, const PCB* pcb, int min_granularity, int target_latency);
+void cfs_account(CfsRunQueue* rq, PCB* pcb, int cycles);
+int cfs_weight_for_nice(int nice);
+
+#endif // CFS_H
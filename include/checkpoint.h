@@ -0,0 +1,16 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "scheduler.h"
+
+#define CHECKPOINT_MAGIC "OSM2CKPT"
+#define CHECKPOINT_VERSION 8
+
+// Binary snapshot of the whole simulation: scheduler queues and counters, every
+// live PCB, memory, semaphores with their wait lists, pending arrivals, input
+// requests with the scripted input feed, and the file cache, including writes not
+// yet on disk. Returns 0 on success, -1 on failure; a failed load changes nothing.
+int checkpoint_save(Scheduler* scheduler, const char* path);
+int checkpoint_load(Scheduler* scheduler, const char* path);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,40 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdbool.h>
+#include "pcb.h"
+#include "scheduler.h"
+
+// Simulated devices. Each serves one operation at a time, in arrival order, and
+// takes service_time cycles per operation; a process that issues one stays blocked
+// until its operation completes. A service time of 0 (the default) makes the
+// device instantaneous and nothing blocks on it.
+typedef enum {
+    DEVICE_DISK,       // readFile, writeFile
+    DEVICE_CONSOLE,    // print, printFromTo
+    DEVICE_COUNT
+} DeviceId;
+
+typedef struct {
+    int service_time;          // cycles per operation, 0 = instantaneous
+    int busy_until;            // cycle at which the last queued operation completes
+    long long operations;
+    long long busy_cycles;     // service time summed over all operations
+    long long queue_cycles;    // cycles operations waited behind earlier ones
+    int max_queue;             // most operations outstanding at once, the new one included
+} Device;
+
+const char* device_name(DeviceId id);
+DeviceId device_by_name(const char* name);
+void device_set_service_time(DeviceId id, int cycles);
+bool device_is_timed(DeviceId id);
+int device_reserve(DeviceId id, int now);
+bool device_block(PCB* pcb, DeviceId id);
+void device_add_waiter(PCB* pcb);
+int device_deliver(Scheduler* scheduler);
+int device_next_due();
+void device_snapshot(Device out[DEVICE_COUNT]);
+void device_restore(const Device in[DEVICE_COUNT]);
+void device_reset();
+
+#endif // DEVICE_H
@@ -0,0 +1,53 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdbool.h>
+#include "logger.h"
+
+// Change notifications for frontends, so they can update what changed instead of
+// re-reading every getter each tick. Two ways to receive them:
+//  - callbacks, run synchronously on the thread that made the change (a CPU
+//    thread in parallel mode), possibly with simulator locks held: they must not
+//    call back into the simulator, only copy what they need;
+//  - the event queue, drained with events_poll(); on Linux events_fd() is an
+//    eventfd that is readable while the queue is not empty.
+// Nothing is recorded while there are no subscribers and the queue is off.
+typedef enum {
+    EVENT_STATE,       // process a went from state c to state b
+    EVENT_QUEUE,       // process a entered (b = 1) or left (b = 0) a ready or blocked queue
+    EVENT_MEMORY,      // memory words a..b changed; c = owning pid, 0 if freed
+    EVENT_LOG,         // text holds the log line
+    EVENT_CLOCK,       // clock cycle a has been simulated
+    EVENT_RESET,       // everything changed (reset, checkpoint load); re-read all state
+    EVENT_OVERFLOW,    // the queue was full and a events were dropped; re-read all state
+    EVENT_TYPE_COUNT
+} EventType;
+
+#define EVENT_MASK(type) (1u << (type))
+#define EVENT_MASK_ALL ((1u << EVENT_TYPE_COUNT) - 1)
+#define EVENT_QUEUE_CAPACITY 4096
+#define MAX_EVENT_SUBSCRIBERS 8
+
+typedef struct {
+    int type;                       // EventType
+    int cycle;                      // clock cycle it happened in
+    int a;
+    int b;
+    int c;
+    char text[MAX_LOG_LENGTH];      // EVENT_LOG only
+} SchedulerEvent;
+
+typedef void (*EventCallback)(const SchedulerEvent* event, void* user_data);
+
+int events_subscribe(unsigned mask, EventCallback callback, void* user_data);
+void events_unsubscribe(int id);
+void events_set_queue_mask(unsigned mask);
+int events_poll(SchedulerEvent* out, int max);
+int events_fd();
+bool events_wanted(EventType type);
+const char* event_type_name(EventType type);
+void event_emit(EventType type, int a, int b, int c);
+void event_emit_text(EventType type, const char* text);
+void events_after_fork();
+
+#endif // EVENTS_H
@@ -13,8 +13,6 @@ extern int scheduler_initialized;
 extern Memory memory;
 extern ResourceManager resource_manager;
 extern Logger logger;
-extern char gui_input_buffer[256];
-extern int gui_input_ready;
 void set_last_log(const char* msg);
 
 
@@ -0,0 +1,35 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include "pcb.h"
+
+#define MAX_INPUT_VALUE 256
+#define MAX_INPUT_PROMPT (MAX_PROGRAM_NAME_LENGTH + 128)   // program name, PID and variable
+
+// One outstanding `assign x input`, kept in the order the processes asked
+typedef struct {
+    int pid;
+    PCB* pcb;
+    char variable[64];
+    char prompt[MAX_INPUT_PROMPT];
+    bool answered;
+    char answer[MAX_INPUT_VALUE];
+} InputRequest;
+
+bool input_take_answer(PCB* pcb, char* buffer, int size);
+void input_request(PCB* pcb, const char* variable);
+int input_answer(int pid, const char* value);
+int input_pending_count();
+int input_oldest_pending_pid();
+const char* input_oldest_prompt();
+const char* input_pending_requests();
+int input_load_script(const char* path);
+void input_add_scripted_answer(const char* value);
+const InputRequest* input_requests(int* count);
+int input_script_state(char* const** answers, const char** path, long* offset);
+bool input_restore_script(char* const* answers, int count, const char* path, long offset);
+void input_restore_request(PCB* pcb, const char* variable, const char* prompt, bool answered, const char* answer);
+void input_reset();
+
+#endif // INPUT_H
@@ -12,17 +12,44 @@ typedef enum {
     INSTR_WRITE_FILE,
     INSTR_READ_FILE,
     INSTR_PRINT_FROM_TO,
-    INSTR_SEM_WAIT,
+    INSTR_SEM_WAIT,     // semWait <name> [timeout]: give up and move on after timeout cycles
     INSTR_SEM_SIGNAL,
+    INSTR_SEM_INIT,     // load-time declaration: semInit <name> <count>
+    INSTR_ADD,          // add <x> <a> <b>: x = a + b (operands are variables or integers)
+    INSTR_SUB,
+    INSTR_MUL,
+    INSTR_DIV,
+    INSTR_EQ,           // eq <x> <a> <b>: x = 1 if a == b, else 0
+    INSTR_NE,
+    INSTR_LT,
+    INSTR_LE,
+    INSTR_GT,
+    INSTR_GE,
+    INSTR_JMP,          // jmp <label>
+    INSTR_JZ,           // jz <x> <label>: jump if x is 0
+    INSTR_JNZ,
+    INSTR_SLEEP,        // sleep <n>: block for n cycles (variable or integer)
     INSTR_UNKNOWN
 } InstructionType;
 
 InstructionType parse_instruction(const char* instruction);
 
+bool instruction_writes_variable(InstructionType type);
+
+int branch_target_token(InstructionType type);
+
+int instruction_cost(InstructionType type);
+
+void set_instruction_cost(InstructionType type, int cycles);
+
 PCB* execute_instruction(PCB* pcb, Memory* memory, ResourceManager* resources, Logger* logger, bool* success);
 
 PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resources, Logger* logger, bool* success);
 
+int execute_instruction_run(PCB* pcb, int budget);
+
+const char* interpreter_dispatch_mode();
+
 bool load_program(Memory* memory, PCB* pcb, const char* filename);
 
 void set_gui_input(const char* input);
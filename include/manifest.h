@@ -0,0 +1,35 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <stdbool.h>
+
+#define MANIFEST_MAX_PATH 512
+#define MANIFEST_MAX_ERRORS 32     // error lines kept; the rest are only counted
+#define MANIFEST_MAX_REPEAT 1000000
+
+// One manifest line:  <program> <arrival> [priority=N] [nice=N | weight=N] [repeat=N]
+// Blank lines and lines starting with '#' are skipped. Relative program paths are
+// looked up next to the manifest first.
+typedef struct {
+    char path[MANIFEST_MAX_PATH];
+    int line;
+    int arrival;
+    int priority;      // 0 = leave the default
+    int nice;
+    bool has_nice;
+    int repeat;
+} ManifestEntry;
+
+typedef struct {
+    ManifestEntry* entries;
+    int count;
+    int capacity;
+    char errors[MANIFEST_MAX_ERRORS][160];
+    int error_count;   // every error, including the ones not kept
+} Manifest;
+
+int manifest_parse(const char* path, Manifest* manifest);
+void manifest_error(Manifest* manifest, int line, const char* format, ...);
+void manifest_free(Manifest* manifest);
+
+#endif // MANIFEST_H
@@ -5,6 +5,9 @@
 #include "pcb.h"
 
 #define MEMORY_SIZE 60  
+#define MEMORY_SHARED_PID -1      // owner of the words in a shared text segment
+#define MAX_TEXT_SEGMENTS MEMORY_SIZE
+#define PCB_MEMORY_WORDS 1        // per-process words ahead of the variables (process state)
 
 typedef struct {
     char* name;       
@@ -12,11 +15,29 @@ typedef struct {
     int process_id;  
 } MemoryWord;
 
+// Read-only instructions of one program, mapped once for every process running it
+typedef struct {
+    const void* key;  // Program the text came from, NULL when it cannot be shared with new loads
+    int base;
+    int size;
+    int refs;
+} TextSegment;
+
 typedef struct {
     MemoryWord words[MEMORY_SIZE];  
     int next_free_word;            
+    TextSegment segments[MAX_TEXT_SEGMENTS];
+    int segment_count;
 } Memory;
 
+// Word counts for the memory summary
+typedef struct {
+    int shared;       // words in shared text segments
+    int segments;
+    int private_words;
+    int free_words;
+} MemoryUsage;
+
 void init_memory(Memory* memory);
 
 int allocate_memory(Memory* memory, PCB* pcb, int size);
@@ -31,4 +52,12 @@ void print_memory(const Memory* memory);
 
 bool is_memory_available(const Memory* memory, int size);
 
+int attach_text_segment(Memory* memory, const void* key, char** instructions, int count);
+
+void detach_text_segment(Memory* memory, int base);
+
+const TextSegment* find_text_segment(const Memory* memory, int address);
+
+MemoryUsage get_memory_usage(const Memory* memory);
+
 #endif  // MEMORY_H
\ No newline at end of file
@@ -2,30 +2,67 @@
 #define MUTEX_H
 
 #include "pcb.h"
-#include "logger.h"  
+#include "logger.h"
 
-typedef enum {
+#define MAX_RESOURCE_NAME 64
+#define RESOURCE_INVALID -1
+#define WAIT_LEVELS 4   // one wait bucket per priority (1-4)
+
+// Resource ids are indices into ResourceManager.mutexes. The built-in
+// resources always get the first ids; programs can declare more by name.
+typedef int ResourceType;
+
+enum {
     RESOURCE_USER_INPUT,
     RESOURCE_USER_OUTPUT,
     RESOURCE_FILE,
-    NUM_RESOURCES
-} ResourceType;
+    NUM_BUILTIN_RESOURCES
+};
 
+// Counting semaphore; the built-ins are binary (initial_count 1)
 typedef struct {
-    int locked;
-    int owner_pid;
+    char name[MAX_RESOURCE_NAME];
+    int initial_count;
+    int available;         // units not held by anyone
+    int locked;            // no units available
+    int owner_pid;         // first holder, -1 if none
+    int holder_count;
+    int holder_capacity;
+    PCB** holders;         // one entry per held unit
     int queue_size;
-    int queue_capacity;
-    PCB** waiting_queue;
+    // Waiters: one FIFO per priority, linked through the PCBs; bit i set = bucket i non-empty
+    PCB* wait_head[WAIT_LEVELS];
+    PCB* wait_tail[WAIT_LEVELS];
+    unsigned wait_bitmap;
 } Mutex;
 
+// What sem_acquire does when a new wait closes a deadlock
+typedef enum {
+    DEADLOCK_REPORT_ONLY,      // log it and keep ticking
+    DEADLOCK_ABORT_YOUNGEST,   // terminate the latest-arriving process in the deadlock
+    DEADLOCK_PREEMPT           // take the youngest's units away and roll it back to re-acquire them
+} DeadlockPolicy;
+
 typedef struct {
-    Mutex mutexes[NUM_RESOURCES];
+    Mutex* mutexes;
+    int count;
+    int capacity;
+    int* name_table;       // open addressing: name hash -> resource id, -1 = empty slot
+    int name_table_size;
+    DeadlockPolicy deadlock_policy;
+    int priority_inheritance;  // holders inherit their waiters' priority
 } ResourceManager;
 
 void init_resource_manager(ResourceManager* manager);
-bool sem_wait(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger);
+void destroy_resource_manager(ResourceManager* manager);
+int register_resource(ResourceManager* manager, const char* name, int initial_count);
+ResourceType find_resource(ResourceManager* manager, const char* name);
+bool sem_acquire(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger);
 PCB* sem_signal(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger);
+bool sem_cancel_wait(ResourceManager* manager, PCB* pcb);
 const char* get_resource_name(ResourceType resource);
+const char* get_last_deadlock_report();
+int count_priority_inversions(ResourceManager* manager);
+void invalidate_priority_inversions();
 
-#endif // MUTEX_H
\ No newline at end of file
+#endif // MUTEX_H
@@ -2,6 +2,8 @@
 #define PCB_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "timer.h"
 
 #define MAX_PROGRAM_NAME_LENGTH 256
 
@@ -16,22 +18,55 @@ typedef enum {
 
 
 // Process Control Block structure
-typedef struct {
+typedef struct PCB {
     int pid;
     char program_name[MAX_PROGRAM_NAME_LENGTH];
     ProcessState state;
-    int priority;
+    int priority;            // effective priority (1 = highest), including any inherited boost
+    int base_priority;       // its own priority, as set by the scheduler
+    int inherited_priority;  // best priority among processes waiting on its resources, 0 if none
     int program_counter;
     int memory_lower_bound;
     int memory_upper_bound;
+    int text_base;           // start of its shared text segment in memory, -1 if none
     int arrival_time;
     int quantum_remaining;
-    int time_in_queue;
+    int queued_at;           // aging clock when it entered its current ready/blocked queue
+    int ready_since;         // aging clock when it last became READY
+    int starving;            // starvation alarm already raised for this wait
+    int blocked_index;       // slot in the scheduler's blocked queue, -1 if not blocked there
     char** variables;   
     char** values;     
     int var_count;
-    char** instructions;
+    char** instructions;     // shared with program when it is set; never modify in place
     int instruction_count;
+    uint64_t affinity_mask;  // allowed CPUs (bit i = CPU i), 0 = any
+    int last_cpu;            // CPU it last ran on, -1 if never dispatched
+    int queued_cpu;          // CPU whose ready queue holds it, -1 if not queued
+    struct Program* program; // cached program the instructions belong to, NULL if owned
+    int* resource_ids;       // per instruction: semaphore id resolved at load time, -1 otherwise
+    int waiting_on;          // resource id it is blocked on, -1 if none
+    int granted_resource;    // unit handed over by sem_signal while it was waiting, -1 if none
+    int io_wait;             // blocked on an asynchronous readFile/writeFile
+    int device_wait;         // device it is blocked on (DeviceId), -1 if none
+    int wake_cycle;          // cycle its device operation completes
+    int stall_cycles;        // cycles still owed for a multi-cycle instruction
+    Timer timer;             // sleep / semWait timeout, kind says which
+    unsigned wfg_mark;       // visit stamp for wait-for graph searches
+    unsigned deadlock_mark;  // deadlock generation it was reported in, 0 if none
+    int wait_level;          // semaphore wait bucket it is linked into, -1 if none
+    struct PCB* wait_prev;   // neighbours in that bucket's FIFO
+    struct PCB* wait_next;
+
+    // CFS: virtual runtime and red-black tree links for the run queue
+    long long vruntime;
+    int nice;
+    int weight;
+    int on_rq;
+    int rb_color;
+    struct PCB* rb_left;
+    struct PCB* rb_right;
+    struct PCB* rb_parent;
 } PCB;
 
 // Function declarations
@@ -39,10 +74,16 @@ PCB* create_pcb(int pid, int arrival_time);
 void destroy_pcb(PCB* pcb);
 void set_pcb_state(PCB* pcb, ProcessState state);
 void set_pcb_priority(PCB* pcb, int priority);
+int pcb_priority(const PCB* pcb);
+void set_pcb_inherited_priority(PCB* pcb, int priority);
+void set_pcb_nice(PCB* pcb, int nice);
+void set_pcb_affinity(PCB* pcb, uint64_t mask);
+bool pcb_can_run_on(const PCB* pcb, int cpu_id);
 void set_pcb_memory_bounds(PCB* pcb, int lower, int upper);
 void add_pcb_instruction(PCB* pcb, const char* instruction);
 void update_pcb_variable(PCB* pcb, const char* name, const char* value);
 void update_pcb_state_in_memory(PCB* pcb);
+int pcb_variable_address(const PCB* pcb, int index);
 const char* get_pcb_variable(PCB* pcb, const char* name);
 const char* get_state_string(ProcessState state);
 
@@ -0,0 +1,71 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <time.h>
+
+// Instructions the interpreter can run straight off the decoded table; anything
+// else (I/O, semaphores, strings, input) goes through execute_instruction_core
+typedef enum {
+    OP_SLOW,
+    OP_ASSIGN,          // dest = a
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_JMP,
+    OP_JZ,              // jump to target if a == 0
+    OP_JNZ,
+    OP_COUNT
+} Opcode;
+
+// An operand is a variable slot (index into variable_names) or an integer literal
+typedef struct {
+    int slot;                  // -1 for a literal
+    long long literal;
+} Operand;
+
+typedef struct {
+    Opcode opcode;
+    int dest;                  // variable slot written, -1 if none
+    Operand a;
+    Operand b;
+    int target;                // branch target instruction index
+} DecodedInstruction;
+
+// A parsed program file, shared read-only by every PCB that runs it
+typedef struct Program {
+    char* path;
+    time_t mtime;              // cache key together with path and size
+    long long size;
+    char* text;                // the file contents, one NUL-terminated line per instruction
+    char** instructions;       // pointers into text
+    char** resource_names;     // per instruction: semWait/semSignal operand, NULL otherwise
+    char** resolved_lines;     // per instruction: branch rewritten to its target index, NULL otherwise
+    int instruction_count;
+    int variable_count;        // distinct assign targets, the per-process data words it needs
+    char** variable_names;     // those targets, in first-write order
+    DecodedInstruction* decoded;   // per instruction, decoded once at load
+    char** declarations;       // semInit lines, replayed on every load
+    int declaration_count;
+    int refs;
+} Program;
+
+// Parse counters for get_program_cache_stats()
+typedef struct {
+    long long loads;           // program_load calls that succeeded
+    long long parses;          // files actually read and parsed
+    int cached;                // distinct programs in the cache
+} ProgramCacheStats;
+
+Program* program_load(const char* path);
+void program_release(Program* program);
+void program_cache_clear();
+ProgramCacheStats program_cache_stats();
+
+#endif // PROGRAM_H
@@ -1,12 +1,22 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include <pthread.h>
 #include "pcb.h"
+#include "cfs.h"
 
 // Constants
 #define QUANTUM 10
 #define MAX_QUEUES 5
 #define MAX_PROCESSES 100
+#define MAX_CPUS 64
+
+// MLFQ anti-starvation defaults (in clock cycles, 0 disables)
+#define DEFAULT_BOOST_PERIOD 100
+#define DEFAULT_AGING_THRESHOLD 10     // for priority 2; doubles for each lower level
+#define DEFAULT_STARVATION_THRESHOLD 50
+
+#define MAX_INSTRUCTIONS_PER_CYCLE 1000000
 
 // ProcessQueue structure 
 typedef struct {
@@ -19,24 +29,72 @@ typedef struct {
 typedef enum {
     FCFS,           // First Come First Serve
     RR,             // Round Robin
-    MLFQ            // Multilevel Feedback Queue
+    MLFQ,           // Multilevel Feedback Queue
+    CFS             // Completely Fair Scheduler (virtual runtime)
 } SchedulingAlgorithm;
 
+// Simulated CPU: its own running slot and local run queues
+typedef struct {
+    int id;
+    pthread_mutex_t lock;          // guards this CPU's run queues
+    PCB* running_process;
+    ProcessQueue ready_queues[4];  // For MLFQ (4 priority levels)
+    CfsRunQueue cfs_queue;         // For CFS (vruntime-ordered tree)
+    long long busy_cycles;
+    long long idle_cycles;
+    int dispatches;
+    int migrations;                // dispatches of a process that last ran elsewhere
+    int steals;                    // processes this CPU pulled from a busier one
+} Cpu;
+
+// Counters reported by get_metrics()
+typedef struct {
+    long long dispatches;
+    long long boosts;              // MLFQ: times every process was reset to the top level
+    long long promotions;          // MLFQ: one-level promotions by aging
+    long long demotions;           // MLFQ: one-level demotions after using a full quantum
+    long long starvation_alarms;   // processes that waited READY past the starvation threshold
+    long long total_ready_wait;    // READY cycles summed over all dispatches
+    int max_ready_wait;            // longest single READY wait before a dispatch
+    int max_ready_wait_pid;
+    long long deadlocks;           // deadlocks found by the wait-for graph check
+    long long deadlock_recoveries; // processes aborted or rolled back to break one
+    long long inheritance_boosts;  // holders raised to a waiter's priority
+    long long inversion_cycles;    // cycles processes spent blocked behind a lower-priority holder
+    long long idle_cycles;         // cycles in which no CPU executed anything, skipped ones included
+    long long skipped_cycles;      // idle cycles the event-driven clock jumped over
+    long long timeouts;            // semWaits abandoned when their timeout expired
+} SchedulerMetrics;
+
 // Scheduler structure ✅
 typedef struct {
     SchedulingAlgorithm algorithm;
     int quantum;                   // For RR and MLFQ
-    ProcessQueue ready_queues[4];  // For MLFQ (4 priority levels)
+    Cpu cpus[MAX_CPUS];
+    int num_cpus;
+    int work_stealing;             // idle CPUs pull work from the busiest one
+    int parallel;                  // run each CPU's cycle on its own thread
+    int event_driven;              // jump the clock to the next event when nothing is runnable
+    int verbose;                   // per-cycle and per-dispatch debug output on stdout
     ProcessQueue blocked_queue;
-    PCB* running_process;
+    int min_granularity;           // CFS: shortest slice a process may get
+    int target_latency;            // CFS: period in which every runnable process runs once
+    int boost_period;              // MLFQ: move everything to the top level every N cycles
+    int aging_threshold[4];        // MLFQ: promote after waiting N cycles at a level
+    int starvation_threshold;      // raise an alarm after N cycles READY without running
+    int instructions_per_cycle;    // compute-only instructions a CPU may run per cycle
+    SchedulerMetrics metrics;
     int clock_cycle;
+    int aging_clock;               // cycles charged to queued processes; waits are differences of it
     int next_pid;   
     int initialized;               
 } Scheduler;
 
+// Future arrivals as a binary min-heap on (arrival_time, pid); list[0] arrives first
 typedef struct {
-    PCB* list[MAX_PROCESSES];
+    PCB** list;
     int count;
+    int capacity;
 } PendingList;
 
 extern PendingList pending_list;
@@ -44,8 +102,36 @@ extern PendingList pending_list;
 // Function declarations
 void init_scheduler(Scheduler* scheduler, SchedulingAlgorithm algorithm, int quantum);
 void add_process(Scheduler* scheduler, PCB* pcb);
+void add_pending_process(PCB* pcb);
+PCB* peek_pending_process();
+PCB* pop_pending_process();
+void clear_pending_processes();
+int next_event_time(Scheduler* scheduler);
+void arm_process_timer(PCB* pcb, TimerKind kind, int expires);
+void cancel_process_timer(PCB* pcb);
+void sleep_process(Scheduler* scheduler, PCB* pcb, int cycles);
+int expire_process_timers(Scheduler* scheduler);
+void set_event_driven(Scheduler* scheduler, int enabled);
+void set_cfs_params(Scheduler* scheduler, int min_granularity, int target_latency);
+void set_cpu_count(Scheduler* scheduler, int num_cpus);
+void set_scheduling_algorithm(Scheduler* scheduler, SchedulingAlgorithm algorithm);
+void set_boost_period(Scheduler* scheduler, int cycles);
+void set_aging_threshold(Scheduler* scheduler, int level, int cycles);
+void set_starvation_threshold(Scheduler* scheduler, int cycles);
+void set_instructions_per_cycle(Scheduler* scheduler, int count);
+void age_processes(Scheduler* scheduler);
+void mark_queued(Scheduler* scheduler, PCB* pcb);
+int pcb_time_in_queue(const Scheduler* scheduler, const PCB* pcb);
+int pcb_ready_wait(const Scheduler* scheduler, const PCB* pcb);
+void boost_all_processes(Scheduler* scheduler);
+void reposition_process(Scheduler* scheduler, PCB* pcb);
 PCB* schedule_next_process(Scheduler* scheduler);
-void update_scheduler(Scheduler* scheduler);
+PCB* schedule_next_process_on(Scheduler* scheduler, Cpu* cpu);
+bool cpu_step(Scheduler* scheduler, Cpu* cpu);
+void set_parallel_execution(Scheduler* scheduler, int enabled);
+void set_verbose_output(Scheduler* scheduler, int enabled);
+void scheduler_lock();
+void scheduler_unlock();
 void print_scheduler_status(const Scheduler* scheduler);
 void destroy_scheduler(Scheduler* scheduler);
 PCB* create_process(const char* program_name, int priority);
@@ -59,6 +145,11 @@ void scheduler_step();
 bool is_all_queues_empty(Scheduler* scheduler);
 void print_queues_state(Scheduler* scheduler);
 bool is_in_blocked_queue(Scheduler* scheduler, PCB* pcb);
+void add_to_blocked_queue(Scheduler* scheduler, PCB* pcb);
+bool remove_from_blocked_queue(Scheduler* scheduler, PCB* pcb);
+bool is_in_ready_queue(Scheduler* scheduler, PCB* pcb);
+int cpu_load(const Cpu* cpu);
+PCB* find_process(Scheduler* scheduler, int pid);
 
 
 
@@ -3,8 +3,25 @@
 #define SCHEDULER_API_H
 
 #include "scheduler.h"
+#include "events.h"
 
 void api_init_scheduler(SchedulingAlgorithm algo, int quantum);
+void api_set_cfs_params(int min_granularity, int target_latency);
+void api_set_cpu_count(int num_cpus);
+void api_set_work_stealing(int enabled);
+void api_set_parallel(int enabled);
+void api_set_event_driven(int enabled);
+void api_set_verbose(int enabled);
+void api_set_boost_period(int cycles);
+void api_set_aging_threshold(int level, int cycles);
+void api_set_starvation_threshold(int cycles);
+void api_set_instructions_per_cycle(int count);
+const char* get_metrics();
+void api_set_deadlock_policy(int policy);
+void api_set_priority_inheritance(int enabled);
+const char* get_deadlock_report();
+int set_process_affinity(int pid, unsigned long long mask);
+const char* get_cpu_state();
 void reset_scheduler();
 void step_execution();
 int get_clock_cycle();
@@ -15,7 +32,30 @@ const char* get_memory_state();
 const char* get_mutex_state();
 int get_total_processes();
 int load_process_from_file(const char* path, int arrival_time);  
+int has_pending_processes();
 const char* get_latest_log();  
 const char* get_purpose_msg();  // NEW
+int answer_input(int pid, const char* value);
+const char* get_input_requests();
+int load_input_script(const char* path);
+void add_scripted_input(const char* value);
+int save_checkpoint(const char* path);
+int load_checkpoint(const char* path);
+const char* run_what_if(const char* spec, int max_cycles);
+void api_set_file_mode(int mode);
+int flush_files();
+const char* get_file_stats();
+void api_set_async_io(int enabled, int latency_cycles);
+const char* get_program_cache_stats();
+int api_set_instruction_cost(const char* mnemonic, int cycles);
+int api_set_device_service_time(const char* device, int cycles);
+const char* get_device_stats();
+const char* load_manifest(const char* path);
+int subscribe_events(unsigned mask, EventCallback callback, void* user_data);
+void unsubscribe_events(int id);
+void api_set_event_queue(unsigned mask);
+int poll_events(SchedulerEvent* out, int max);
+int get_event_fd();
+const char* get_events(int max);
 
 #endif // SCHEDULER_API_H
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdbool.h>
+#include "scheduler.h"
+
+// Worker threads that run one simulated CPU each, in lockstep with the global clock
+void smp_start(Scheduler* scheduler);
+void smp_stop();
+void smp_abandon();
+bool smp_is_running();
+int smp_run_cycle(Scheduler* scheduler);
+
+#endif // SMP_H
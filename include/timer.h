@@ -0,0 +1,42 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdbool.h>
+
+// Hierarchical timer wheel over the simulated clock: TIMER_LEVELS levels of
+// TIMER_SLOTS slots, each level TIMER_SLOTS times coarser than the one below.
+// Arming and cancelling are O(1); a timer is cascaded down at most once per level
+// before it expires, so advancing the clock is O(1) amortized per timer.
+#define TIMER_SLOT_BITS 6
+#define TIMER_SLOTS (1 << TIMER_SLOT_BITS)
+#define TIMER_LEVELS 4
+#define TIMER_MAX_DELAY ((1 << (TIMER_SLOT_BITS * TIMER_LEVELS)) - 1)   // longer delays are clamped
+
+// What an expired timer means to its owner
+typedef enum {
+    TIMER_NONE = -1,
+    TIMER_SLEEP,           // sleep instruction: wake the process
+    TIMER_SEM_TIMEOUT      // semWait with a timeout: give up waiting
+} TimerKind;
+
+// Embedded in its owner; no allocation on arm or cancel
+typedef struct Timer {
+    int expires;           // clock cycle it fires at
+    int kind;              // TimerKind, for the owner
+    void* owner;
+    int level;             // wheel position, -1 when not armed
+    int slot;
+    struct Timer* prev;
+    struct Timer* next;    // also links the list timer_advance returns
+} Timer;
+
+void timer_init(Timer* timer, void* owner);
+void timer_arm(Timer* timer, int expires);
+bool timer_cancel(Timer* timer);
+bool timer_armed(const Timer* timer);
+Timer* timer_advance(int now);
+int timer_next_expiry();
+int timer_count();
+void timer_reset(int now);
+
+#endif // TIMER_H
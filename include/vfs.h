@@ -0,0 +1,47 @@
+#ifndef VFS_H
+#define VFS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define VFS_MAX_OPEN_HANDLES 16
+#define VFS_WRITE_BACK_LIMIT (1 << 20)   // dirty bytes before write-back flushes early
+
+// How writeFile/readFile reach the disk
+typedef enum {
+    VFS_WRITE_THROUGH,   // every write hits the disk (through a cached open handle)
+    VFS_WRITE_BACK,      // writes coalesce in memory; flushed when the run ends or on demand
+    VFS_MEMORY           // files live only in memory until vfs_flush is called
+} VfsMode;
+
+// I/O counters for get_file_stats()
+typedef struct {
+    long long reads;          // readFile executions served
+    long long writes;         // writeFile executions
+    long long cache_hits;     // reads answered without touching the disk
+    long long disk_reads;     // files loaded from disk
+    long long disk_writes;    // file contents written to disk
+    long long opens;          // fopen calls
+} VfsStats;
+
+// One cached file, as checkpoints save it
+typedef struct {
+    char* path;
+    char* data;
+    size_t length;
+    bool dirty;               // not yet written to disk
+} VfsFileImage;
+
+void vfs_set_mode(VfsMode mode);
+VfsMode vfs_get_mode();
+bool vfs_write(const char* path, const char* data);
+char* vfs_read(const char* path);
+int vfs_flush();
+void vfs_sync();
+void vfs_reset();
+VfsStats vfs_get_stats();
+int vfs_snapshot(VfsFileImage** images);
+void vfs_free_images(VfsFileImage* images, int count);
+void vfs_restore(VfsMode mode, const VfsStats* saved_stats, VfsFileImage* images, int count);
+
+#endif // VFS_H
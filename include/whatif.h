@@ -0,0 +1,30 @@
+#ifndef WHATIF_H
+#define WHATIF_H
+
+#include "scheduler.h"
+
+#define WHATIF_MAX_BRANCHES 64
+#define WHATIF_DEFAULT_MAX_CYCLES 10000
+
+// One alternative future for the current simulation
+typedef struct {
+    int algorithm;              // -1 keeps the current policy
+    int quantum;                // 0 keeps the current quantum
+    char input_script[256];     // answers for `assign x input`, empty for none
+    int max_cycles;             // stop the branch after this many cycles
+} WhatIfBranch;
+
+// What a branch reported back to the parent
+typedef struct {
+    int ok;                     // the branch ran and reported
+    int clock_cycle;
+    int finished;               // every process completed within max_cycles
+    int remaining;              // processes still in the system when it stopped
+    SchedulerMetrics metrics;
+} WhatIfResult;
+
+// Forks one copy of the simulation per branch and runs them side by side.
+// The live simulation is not touched. Returns the number of branches that reported.
+int whatif_run(Scheduler* scheduler, const WhatIfBranch* branches, int count, WhatIfResult* results);
+
+#endif // WHATIF_H
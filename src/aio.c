@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "aio.h"
+#include "device.h"
+#include "globals.h"
+#include "queue.h"
+#include "vfs.h"
+
+// readFile/writeFile go to a small pool of I/O threads while the issuing process
+// sits in the blocked queue. The real I/O overlaps with the simulated cycles in
+// between; the simulation sees the completion exactly latency cycles after the
+// submission (waiting for the thread if it is late), so runs stay reproducible.
+
+static pthread_mutex_t aio_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+static int worker_count = 0;
+static bool aio_enabled = false;
+static int aio_latency = AIO_DEFAULT_LATENCY;
+
+static AioRequest* queue_head = NULL;       // waiting for a worker
+static AioRequest* queue_tail = NULL;
+static AioRequest* flight_head = NULL;      // submitted, not yet delivered, in submission order
+static AioRequest* flight_tail = NULL;
+static AioRequest* completed_head = NULL;   // delivered, waiting for the process to pick up
+
+static void perform(AioRequest* request) {
+    bool ok;
+    if (request->op == AIO_READ) {
+        request->data = vfs_read(request->path);
+        ok = request->data != NULL;
+    } else {
+        ok = vfs_write(request->path, request->data);
+    }
+    pthread_mutex_lock(&aio_mutex);
+    request->ok = ok;
+    request->done = true;
+    pthread_cond_broadcast(&work_done);
+    pthread_mutex_unlock(&aio_mutex);
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&aio_mutex);
+        while (!queue_head) {
+            pthread_cond_wait(&work_ready, &aio_mutex);
+        }
+        AioRequest* request = queue_head;
+        queue_head = request->work_next;
+        if (!queue_head) queue_tail = NULL;
+        pthread_mutex_unlock(&aio_mutex);
+        perform(request);
+    }
+    return NULL;
+}
+
+// Workers start on first use and live as long as the process
+static void start_workers_locked() {
+    while (worker_count < AIO_WORKERS) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, worker_main, NULL) != 0) {
+            printf("[ERROR] Failed to start I/O worker %d\n", worker_count);
+            break;
+        }
+        pthread_detach(thread);
+        worker_count++;
+    }
+}
+
+void aio_set_enabled(bool enabled) {
+    aio_enabled = enabled;
+    printf("[AIO] Asynchronous file I/O %s (latency %d cycle(s))\n", enabled ? "enabled" : "disabled", aio_latency);
+}
+
+bool aio_is_enabled() {
+    return aio_enabled;
+}
+
+void aio_set_latency(int cycles) {
+    if (cycles < 1) cycles = 1;
+    aio_latency = cycles;
+}
+
+// Queue the I/O and block pcb until aio_deliver hands the completion back
+void aio_submit(PCB* pcb, AioOp op, const char* path, const char* data) {
+    if (!pcb || !path) return;
+    AioRequest* request = calloc(1, sizeof(AioRequest));
+    if (!request) {
+        fprintf(stderr, "Failed to allocate I/O request!\n");
+        exit(EXIT_FAILURE);
+    }
+    request->op = op;
+    request->pcb = pcb;
+    request->pid = pcb->pid;
+    request->path = strdup(path);
+    request->data = data ? strdup(data) : NULL;
+    // A timed disk decides when the request completes; otherwise the fixed latency does
+    request->due_cycle = device_is_timed(DEVICE_DISK) ? device_reserve(DEVICE_DISK, scheduler->clock_cycle)
+                                                      : scheduler->clock_cycle + aio_latency;
+
+    pthread_mutex_lock(&aio_mutex);
+    start_workers_locked();
+    if (flight_tail) flight_tail->next = request;
+    else flight_head = request;
+    flight_tail = request;
+    bool threaded = worker_count > 0;
+    if (threaded) {
+        if (queue_tail) queue_tail->work_next = request;
+        else queue_head = request;
+        queue_tail = request;
+        pthread_cond_signal(&work_ready);
+    }
+    pthread_mutex_unlock(&aio_mutex);
+    // No threads: still deliver through the same path, just without the overlap
+    if (!threaded) perform(request);
+
+    scheduler_lock();
+    pcb->io_wait = 1;
+    set_pcb_state(pcb, BLOCKED);
+    add_to_blocked_queue(scheduler, pcb);
+    scheduler_unlock();
+    printf("[AIO] PID %d submitted %s of [%s], due at cycle %d\n",
+        pcb->pid, op == AIO_READ ? "read" : "write", path, request->due_cycle);
+}
+
+// The completed request for pcb, or NULL; the caller frees it
+AioRequest* aio_take_completion(PCB* pcb) {
+    if (!pcb) return NULL;
+    pthread_mutex_lock(&aio_mutex);
+    AioRequest** link = &completed_head;
+    while (*link && (*link)->pid != pcb->pid) link = &(*link)->next;
+    AioRequest* request = *link;
+    if (request) *link = request->next;
+    pthread_mutex_unlock(&aio_mutex);
+    return request;
+}
+
+void aio_free_request(AioRequest* request) {
+    if (!request) return;
+    free(request->path);
+    free(request->data);
+    free(request);
+}
+
+// Once per cycle: unblock every process whose I/O is due. Returns how many were woken.
+int aio_deliver(Scheduler* scheduler) {
+    if (!scheduler) return 0;
+    PCB* woken[64];
+    int delivered = 0;
+    bool more = true;
+    while (more) {
+        int count = 0;
+        more = false;
+        pthread_mutex_lock(&aio_mutex);
+        AioRequest** link = &flight_head;
+        AioRequest* previous = NULL;
+        while (*link) {
+            AioRequest* request = *link;
+            if (request->due_cycle > scheduler->clock_cycle) {
+                previous = request;
+                link = &request->next;
+                continue;
+            }
+            if (count == (int)(sizeof(woken) / sizeof(woken[0]))) {
+                more = true;
+                break;
+            }
+            while (!request->done) {
+                pthread_cond_wait(&work_done, &aio_mutex);
+            }
+            *link = request->next;
+            if (flight_tail == request) flight_tail = previous;
+            request->next = completed_head;
+            completed_head = request;
+            woken[count++] = request->pcb;
+        }
+        pthread_mutex_unlock(&aio_mutex);
+
+        scheduler_lock();
+        for (int i = 0; i < count; i++) {
+            PCB* pcb = woken[i];
+            pcb->io_wait = 0;
+            if (remove_from_blocked_queue(scheduler, pcb)) add_process(scheduler, pcb);
+            printf("[AIO] I/O for PID %d completed at cycle %d\n", pcb->pid, scheduler->clock_cycle);
+        }
+        scheduler_unlock();
+        delivered += count;
+    }
+    return delivered;
+}
+
+// Earliest cycle at which a completion is due, -1 if nothing is in flight
+int aio_next_due() {
+    int next = -1;
+    pthread_mutex_lock(&aio_mutex);
+    for (AioRequest* request = flight_head; request; request = request->next) {
+        if (next < 0 || request->due_cycle < next) next = request->due_cycle;
+    }
+    pthread_mutex_unlock(&aio_mutex);
+    return next;
+}
+
+// Wait until the workers have finished every submitted request
+void aio_quiesce() {
+    pthread_mutex_lock(&aio_mutex);
+    for (AioRequest* request = flight_head; request; request = request->next) {
+        while (!request->done) {
+            pthread_cond_wait(&work_done, &aio_mutex);
+        }
+    }
+    pthread_mutex_unlock(&aio_mutex);
+}
+
+// In a fork()ed child the workers are gone; new ones start on the next submission.
+// Call aio_quiesce() in the parent first so nothing is left half-done.
+void aio_after_fork() {
+    pthread_mutex_init(&aio_mutex, NULL);
+    pthread_cond_init(&work_ready, NULL);
+    pthread_cond_init(&work_done, NULL);
+    worker_count = 0;
+}
+
+// Drop every request; their PCBs do not survive a reset or a checkpoint restore
+void aio_reset() {
+    aio_quiesce();
+    pthread_mutex_lock(&aio_mutex);
+    AioRequest* lists[2] = {flight_head, completed_head};
+    for (int i = 0; i < 2; i++) {
+        AioRequest* request = lists[i];
+        while (request) {
+            AioRequest* next = request->next;
+            aio_free_request(request);
+            request = next;
+        }
+    }
+    flight_head = flight_tail = NULL;
+    completed_head = NULL;
+    pthread_mutex_unlock(&aio_mutex);
+}
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include "cfs.h"
+#include "events.h"
+
+#define RB_RED 0
+#define RB_BLACK 1
+
+// Linux's nice-to-weight table: each nice step is roughly a 10% CPU share change
+static const int nice_to_weight[40] = {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+};
+
+int cfs_weight_for_nice(int nice) {
+    if (nice < CFS_MIN_NICE) nice = CFS_MIN_NICE;
+    if (nice > CFS_MAX_NICE) nice = CFS_MAX_NICE;
+    return nice_to_weight[nice - CFS_MIN_NICE];
+}
+
+void cfs_init(CfsRunQueue* rq) {
+    rq->root = NULL;
+    rq->leftmost = NULL;
+    rq->count = 0;
+    rq->total_weight = 0;
+    rq->min_vruntime = 0;
+}
+
+bool cfs_is_empty(const CfsRunQueue* rq) {
+    return rq->count == 0;
+}
+
+static bool entity_before(const PCB* a, const PCB* b) {
+    if (a->vruntime != b->vruntime) return a->vruntime < b->vruntime;
+    return a->pid < b->pid;
+}
+
+static int color_of(const PCB* node) {
+    return node ? node->rb_color : RB_BLACK;
+}
+
+static void rotate_left(CfsRunQueue* rq, PCB* x) {
+    PCB* y = x->rb_right;
+    x->rb_right = y->rb_left;
+    if (y->rb_left) y->rb_left->rb_parent = x;
+    y->rb_parent = x->rb_parent;
+    if (!x->rb_parent) rq->root = y;
+    else if (x == x->rb_parent->rb_left) x->rb_parent->rb_left = y;
+    else x->rb_parent->rb_right = y;
+    y->rb_left = x;
+    x->rb_parent = y;
+}
+
+static void rotate_right(CfsRunQueue* rq, PCB* x) {
+    PCB* y = x->rb_left;
+    x->rb_left = y->rb_right;
+    if (y->rb_right) y->rb_right->rb_parent = x;
+    y->rb_parent = x->rb_parent;
+    if (!x->rb_parent) rq->root = y;
+    else if (x == x->rb_parent->rb_right) x->rb_parent->rb_right = y;
+    else x->rb_parent->rb_left = y;
+    y->rb_right = x;
+    x->rb_parent = y;
+}
+
+static PCB* subtree_min(PCB* node) {
+    while (node && node->rb_left) node = node->rb_left;
+    return node;
+}
+
+PCB* cfs_next(const PCB* pcb) {
+    if (!pcb) return NULL;
+    if (pcb->rb_right) return subtree_min(pcb->rb_right);
+    const PCB* node = pcb;
+    PCB* parent = node->rb_parent;
+    while (parent && node == parent->rb_right) {
+        node = parent;
+        parent = parent->rb_parent;
+    }
+    return parent;
+}
+
+static void insert_fixup(CfsRunQueue* rq, PCB* z) {
+    while (z->rb_parent && z->rb_parent->rb_color == RB_RED) {
+        PCB* parent = z->rb_parent;
+        PCB* grandparent = parent->rb_parent;
+        if (parent == grandparent->rb_left) {
+            PCB* uncle = grandparent->rb_right;
+            if (color_of(uncle) == RB_RED) {
+                parent->rb_color = RB_BLACK;
+                uncle->rb_color = RB_BLACK;
+                grandparent->rb_color = RB_RED;
+                z = grandparent;
+            } else {
+                if (z == parent->rb_right) {
+                    z = parent;
+                    rotate_left(rq, z);
+                    parent = z->rb_parent;
+                }
+                parent->rb_color = RB_BLACK;
+                grandparent->rb_color = RB_RED;
+                rotate_right(rq, grandparent);
+            }
+        } else {
+            PCB* uncle = grandparent->rb_left;
+            if (color_of(uncle) == RB_RED) {
+                parent->rb_color = RB_BLACK;
+                uncle->rb_color = RB_BLACK;
+                grandparent->rb_color = RB_RED;
+                z = grandparent;
+            } else {
+                if (z == parent->rb_left) {
+                    z = parent;
+                    rotate_right(rq, z);
+                    parent = z->rb_parent;
+                }
+                parent->rb_color = RB_BLACK;
+                grandparent->rb_color = RB_RED;
+                rotate_left(rq, grandparent);
+            }
+        }
+    }
+    rq->root->rb_color = RB_BLACK;
+}
+
+void cfs_enqueue(CfsRunQueue* rq, PCB* pcb) {
+    if (!rq || !pcb || pcb->on_rq) return;
+
+    // A process that slept or just arrived must not bank credit against the others
+    if (pcb->vruntime < rq->min_vruntime) pcb->vruntime = rq->min_vruntime;
+
+    PCB* parent = NULL;
+    PCB** link = &rq->root;
+    bool leftmost = true;
+    while (*link) {
+        parent = *link;
+        if (entity_before(pcb, parent)) {
+            link = &parent->rb_left;
+        } else {
+            link = &parent->rb_right;
+            leftmost = false;
+        }
+    }
+
+    pcb->rb_parent = parent;
+    pcb->rb_left = NULL;
+    pcb->rb_right = NULL;
+    pcb->rb_color = RB_RED;
+    *link = pcb;
+    if (leftmost) rq->leftmost = pcb;
+
+    insert_fixup(rq, pcb);
+    pcb->on_rq = 1;
+    // Other CPUs read the count without the lock (cpu_load)
+    __atomic_store_n(&rq->count, rq->count + 1, __ATOMIC_RELAXED);
+    rq->total_weight += pcb->weight;
+    event_emit(EVENT_QUEUE, pcb->pid, 1, 0);
+}
+
+static void transplant(CfsRunQueue* rq, PCB* u, PCB* v) {
+    if (!u->rb_parent) rq->root = v;
+    else if (u == u->rb_parent->rb_left) u->rb_parent->rb_left = v;
+    else u->rb_parent->rb_right = v;
+    if (v) v->rb_parent = u->rb_parent;
+}
+
+static void delete_fixup(CfsRunQueue* rq, PCB* x, PCB* x_parent) {
+    while (x != rq->root && color_of(x) == RB_BLACK) {
+        if (x == x_parent->rb_left) {
+            PCB* w = x_parent->rb_right;
+            if (color_of(w) == RB_RED) {
+                w->rb_color = RB_BLACK;
+                x_parent->rb_color = RB_RED;
+                rotate_left(rq, x_parent);
+                w = x_parent->rb_right;
+            }
+            if (color_of(w->rb_left) == RB_BLACK && color_of(w->rb_right) == RB_BLACK) {
+                w->rb_color = RB_RED;
+                x = x_parent;
+                x_parent = x->rb_parent;
+            } else {
+                if (color_of(w->rb_right) == RB_BLACK) {
+                    w->rb_left->rb_color = RB_BLACK;
+                    w->rb_color = RB_RED;
+                    rotate_right(rq, w);
+                    w = x_parent->rb_right;
+                }
+                w->rb_color = x_parent->rb_color;
+                x_parent->rb_color = RB_BLACK;
+                if (w->rb_right) w->rb_right->rb_color = RB_BLACK;
+                rotate_left(rq, x_parent);
+                x = rq->root;
+                break;
+            }
+        } else {
+            PCB* w = x_parent->rb_left;
+            if (color_of(w) == RB_RED) {
+                w->rb_color = RB_BLACK;
+                x_parent->rb_color = RB_RED;
+                rotate_right(rq, x_parent);
+                w = x_parent->rb_left;
+            }
+            if (color_of(w->rb_right) == RB_BLACK && color_of(w->rb_left) == RB_BLACK) {
+                w->rb_color = RB_RED;
+                x = x_parent;
+                x_parent = x->rb_parent;
+            } else {
+                if (color_of(w->rb_left) == RB_BLACK) {
+                    w->rb_right->rb_color = RB_BLACK;
+                    w->rb_color = RB_RED;
+                    rotate_left(rq, w);
+                    w = x_parent->rb_left;
+                }
+                w->rb_color = x_parent->rb_color;
+                x_parent->rb_color = RB_BLACK;
+                if (w->rb_left) w->rb_left->rb_color = RB_BLACK;
+                rotate_right(rq, x_parent);
+                x = rq->root;
+                break;
+            }
+        }
+    }
+    if (x) x->rb_color = RB_BLACK;
+}
+
+void cfs_dequeue(CfsRunQueue* rq, PCB* z) {
+    if (!rq || !z || !z->on_rq) return;
+
+    if (rq->leftmost == z) rq->leftmost = cfs_next(z);
+
+    PCB* x;
+    PCB* x_parent;
+    int removed_color = z->rb_color;
+
+    if (!z->rb_left) {
+        x = z->rb_right;
+        x_parent = z->rb_parent;
+        transplant(rq, z, z->rb_right);
+    } else if (!z->rb_right) {
+        x = z->rb_left;
+        x_parent = z->rb_parent;
+        transplant(rq, z, z->rb_left);
+    } else {
+        PCB* y = subtree_min(z->rb_right);
+        removed_color = y->rb_color;
+        x = y->rb_right;
+        if (y->rb_parent == z) {
+            x_parent = y;
+        } else {
+            x_parent = y->rb_parent;
+            transplant(rq, y, y->rb_right);
+            y->rb_right = z->rb_right;
+            y->rb_right->rb_parent = y;
+        }
+        transplant(rq, z, y);
+        y->rb_left = z->rb_left;
+        y->rb_left->rb_parent = y;
+        y->rb_color = z->rb_color;
+    }
+
+    if (removed_color == RB_BLACK) delete_fixup(rq, x, x_parent);
+
+    z->rb_left = z->rb_right = z->rb_parent = NULL;
+    z->on_rq = 0;
+    __atomic_store_n(&rq->count, rq->count - 1, __ATOMIC_RELAXED);
+    rq->total_weight -= z->weight;
+    event_emit(EVENT_QUEUE, z->pid, 0, 0);
+}
+
+PCB* cfs_peek(const CfsRunQueue* rq) {
+    return rq ? rq->leftmost : NULL;
+}
+
+PCB* cfs_pick_next(CfsRunQueue* rq) {
+    PCB* next = cfs_peek(rq);
+    if (next) cfs_dequeue(rq, next);
+    return next;
+}
+
+// Share of the target latency proportional to weight, never below the minimum granularity
+int cfs_timeslice(const CfsRunQueue* rq, const PCB* pcb, int min_granularity, int target_latency) {
+    if (min_granularity < 1) min_granularity = 1;
+    int nr_running = rq->count + (pcb->on_rq ? 0 : 1);
+    long long total_weight = rq->total_weight + (pcb->on_rq ? 0 : pcb->weight);
+
+    long long period = target_latency;
+    if ((long long)nr_running * min_granularity > period) {
+        period = (long long)nr_running * min_granularity;
+    }
+    long long slice = total_weight > 0 ? period * pcb->weight / total_weight : period;
+    if (slice < min_granularity) slice = min_granularity;
+    return (int)slice;
+}
+
+// Charge a running (dequeued) process for the cycles it consumed
+void cfs_account(CfsRunQueue* rq, PCB* pcb, int cycles) {
+    if (!pcb || cycles <= 0) return;
+    int weight = pcb->weight > 0 ? pcb->weight : CFS_NICE_0_WEIGHT;
+    pcb->vruntime += (long long)cycles * CFS_NICE_0_WEIGHT * CFS_VRUNTIME_SCALE / weight;
+
+    long long candidate = pcb->vruntime;
+    if (rq->leftmost && rq->leftmost->vruntime < candidate) candidate = rq->leftmost->vruntime;
+    if (candidate > rq->min_vruntime) rq->min_vruntime = candidate;
+}
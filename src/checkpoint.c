@@ -0,0 +1,1019 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "aio.h"
+#include "checkpoint.h"
+#include "device.h"
+#include "globals.h"
+#include "input.h"
+#include "interpreter.h"
+#include "memory.h"
+#include "mutex.h"
+#include "pcb.h"
+#include "queue.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "vfs.h"
+
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+#define CHECKPOINT_IO_BUFFER (1 << 20)
+#define CHECKPOINT_MAX_STRING (1 << 20)
+#define CHECKPOINT_MAX_PROCESSES (1 << 24)
+#define CHECKPOINT_MAX_FILE_BYTES (1LL << 31)
+#define CHECKPOINT_END 0x21444e45u   // "END!"
+
+// Every pointer is written as an index into the process table (-1 = none), in
+// native byte order; the header rejects files written on a foreign-endian host.
+
+// ---------------------------------------------------------------- writing
+
+static void put_i32(FILE* file, int32_t value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+static void put_i64(FILE* file, int64_t value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+static void put_str(FILE* file, const char* value) {
+    if (!value) {
+        put_i32(file, -1);
+        return;
+    }
+    int32_t length = (int32_t)strlen(value);
+    put_i32(file, length);
+    fwrite(value, 1, length, file);
+}
+
+typedef struct {
+    PCB** items;
+    int count;
+    int capacity;
+} PcbTable;
+
+static void table_add(PcbTable* table, PCB* pcb) {
+    if (!pcb) return;
+    if (table->count == table->capacity) {
+        int capacity = table->capacity ? table->capacity * 2 : 64;
+        PCB** grown = realloc(table->items, capacity * sizeof(PCB*));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow checkpoint process table!\n");
+            exit(EXIT_FAILURE);
+        }
+        table->items = grown;
+        table->capacity = capacity;
+    }
+    table->items[table->count++] = pcb;
+}
+
+static int compare_pid(const void* a, const void* b) {
+    int pa = (*(PCB* const*)a)->pid;
+    int pb = (*(PCB* const*)b)->pid;
+    return (pa > pb) - (pa < pb);
+}
+
+// Every PCB reachable from the scheduler, the semaphores or the input queue, sorted by pid
+static void collect_processes(Scheduler* scheduler, PcbTable* table) {
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        table_add(table, cpu->running_process);
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < cpu->ready_queues[i].size; j++) {
+                table_add(table, cpu->ready_queues[i].processes[j]);
+            }
+        }
+        for (PCB* pcb = cfs_peek(&cpu->cfs_queue); pcb; pcb = cfs_next(pcb)) {
+            table_add(table, pcb);
+        }
+    }
+    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
+        table_add(table, scheduler->blocked_queue.processes[i]);
+    }
+    for (int i = 0; i < pending_list.count; i++) {
+        table_add(table, pending_list.list[i]);
+    }
+    for (int r = 0; r < resource_manager.count; r++) {
+        Mutex* mutex = &resource_manager.mutexes[r];
+        for (int h = 0; h < mutex->holder_count; h++) {
+            table_add(table, mutex->holders[h]);
+        }
+        for (int level = 0; level < WAIT_LEVELS; level++) {
+            for (PCB* pcb = mutex->wait_head[level]; pcb; pcb = pcb->wait_next) {
+                table_add(table, pcb);
+            }
+        }
+    }
+    int input_count = 0;
+    const InputRequest* inputs = input_requests(&input_count);
+    for (int i = 0; i < input_count; i++) {
+        table_add(table, inputs[i].pcb);
+    }
+
+    if (table->count == 0) return;
+    qsort(table->items, table->count, sizeof(PCB*), compare_pid);
+    int unique = 0;
+    for (int i = 0; i < table->count; i++) {
+        if (unique == 0 || table->items[unique - 1] != table->items[i]) {
+            table->items[unique++] = table->items[i];
+        }
+    }
+    table->count = unique;
+}
+
+static int32_t index_of(const PcbTable* table, const PCB* pcb) {
+    if (!pcb) return -1;
+    int low = 0, high = table->count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int pid = table->items[mid]->pid;
+        if (pid == pcb->pid) return mid;
+        if (pid < pcb->pid) low = mid + 1;
+        else high = mid - 1;
+    }
+    return -1;
+}
+
+static void put_index_list(FILE* file, const PcbTable* table, PCB** list, int count) {
+    put_i32(file, count);
+    for (int i = 0; i < count; i++) {
+        put_i32(file, index_of(table, list[i]));
+    }
+}
+
+static void put_pcb(FILE* file, const PCB* pcb) {
+    put_i32(file, pcb->pid);
+    put_i32(file, pcb->state);
+    put_i32(file, pcb->priority);
+    put_i32(file, pcb->base_priority);
+    put_i32(file, pcb->inherited_priority);
+    put_i32(file, pcb->program_counter);
+    put_i32(file, pcb->memory_lower_bound);
+    put_i32(file, pcb->memory_upper_bound);
+    put_i32(file, pcb->arrival_time);
+    put_i32(file, pcb->quantum_remaining);
+    put_i32(file, pcb_time_in_queue(scheduler, pcb));
+    put_i32(file, pcb_ready_wait(scheduler, pcb));
+    put_i32(file, pcb->starving);
+    put_i32(file, pcb->last_cpu);
+    put_i32(file, pcb->queued_cpu);
+    put_i32(file, pcb->waiting_on);
+    put_i32(file, pcb->granted_resource);
+    put_i32(file, pcb->io_wait);
+    put_i32(file, pcb->text_base);
+    put_i32(file, pcb->device_wait);
+    put_i32(file, pcb->wake_cycle);
+    put_i32(file, pcb->stall_cycles);
+    put_i32(file, timer_armed(&pcb->timer) ? pcb->timer.kind : TIMER_NONE);
+    put_i32(file, pcb->timer.expires);
+    put_i32(file, pcb->nice);
+    put_i64(file, (int64_t)pcb->affinity_mask);
+    put_i64(file, pcb->vruntime);
+    put_str(file, pcb->program_name);
+    put_i32(file, pcb->instruction_count);
+    for (int i = 0; i < pcb->instruction_count; i++) {
+        put_str(file, pcb->instructions[i]);
+        put_i32(file, pcb->resource_ids ? pcb->resource_ids[i] : RESOURCE_INVALID);
+    }
+    put_i32(file, pcb->var_count);
+    for (int i = 0; i < pcb->var_count; i++) {
+        put_str(file, pcb->variables[i]);
+        put_str(file, pcb->values[i]);
+    }
+}
+
+static void write_metrics(FILE* file, const SchedulerMetrics* metrics) {
+    put_i64(file, metrics->dispatches);
+    put_i64(file, metrics->boosts);
+    put_i64(file, metrics->promotions);
+    put_i64(file, metrics->demotions);
+    put_i64(file, metrics->starvation_alarms);
+    put_i64(file, metrics->total_ready_wait);
+    put_i32(file, metrics->max_ready_wait);
+    put_i32(file, metrics->max_ready_wait_pid);
+    put_i64(file, metrics->deadlocks);
+    put_i64(file, metrics->deadlock_recoveries);
+    put_i64(file, metrics->inheritance_boosts);
+    put_i64(file, metrics->inversion_cycles);
+    put_i64(file, metrics->idle_cycles);
+    put_i64(file, metrics->skipped_cycles);
+    put_i64(file, metrics->timeouts);
+}
+
+static void write_checkpoint(Scheduler* scheduler, FILE* file) {
+    PcbTable table = {NULL, 0, 0};
+    collect_processes(scheduler, &table);
+
+    fwrite(CHECKPOINT_MAGIC, 1, 8, file);
+    put_i32(file, CHECKPOINT_VERSION);
+    put_i32(file, (int32_t)CHECKPOINT_BYTE_ORDER);
+
+    put_i32(file, scheduler->algorithm);
+    put_i32(file, scheduler->quantum);
+    put_i32(file, scheduler->num_cpus);
+    put_i32(file, scheduler->work_stealing);
+    put_i32(file, scheduler->parallel);
+    put_i32(file, scheduler->event_driven);
+    put_i32(file, scheduler->min_granularity);
+    put_i32(file, scheduler->target_latency);
+    put_i32(file, scheduler->boost_period);
+    for (int i = 0; i < 4; i++) put_i32(file, scheduler->aging_threshold[i]);
+    put_i32(file, scheduler->starvation_threshold);
+    put_i32(file, scheduler->instructions_per_cycle);
+    put_i32(file, scheduler->clock_cycle);
+    put_i32(file, scheduler->next_pid);
+    write_metrics(file, &scheduler->metrics);
+
+    put_i32(file, table.count);
+    for (int i = 0; i < table.count; i++) {
+        put_pcb(file, table.items[i]);
+    }
+
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        put_i64(file, cpu->busy_cycles);
+        put_i64(file, cpu->idle_cycles);
+        put_i32(file, cpu->dispatches);
+        put_i32(file, cpu->migrations);
+        put_i32(file, cpu->steals);
+        put_i32(file, index_of(&table, cpu->running_process));
+        for (int i = 0; i < 4; i++) {
+            put_index_list(file, &table, cpu->ready_queues[i].processes, cpu->ready_queues[i].size);
+        }
+        // CFS tree in vruntime order; restore rebuilds the tree from it
+        put_i64(file, cpu->cfs_queue.min_vruntime);
+        put_i32(file, cpu->cfs_queue.count);
+        for (PCB* pcb = cfs_peek(&cpu->cfs_queue); pcb; pcb = cfs_next(pcb)) {
+            put_i32(file, index_of(&table, pcb));
+        }
+    }
+    put_index_list(file, &table, scheduler->blocked_queue.processes, scheduler->blocked_queue.size);
+    // Heap order, so the pending list comes back without re-heapifying
+    put_index_list(file, &table, pending_list.list, pending_list.count);
+
+    put_i32(file, MEMORY_SIZE);
+    put_i32(file, memory.next_free_word);
+    for (int i = 0; i < MEMORY_SIZE; i++) {
+        put_i32(file, memory.words[i].process_id);
+        put_str(file, memory.words[i].name);
+        put_str(file, memory.words[i].data);
+    }
+    put_i32(file, memory.segment_count);
+    for (int i = 0; i < memory.segment_count; i++) {
+        put_i32(file, memory.segments[i].base);
+        put_i32(file, memory.segments[i].size);
+        put_i32(file, memory.segments[i].refs);
+    }
+
+    put_i32(file, resource_manager.deadlock_policy);
+    put_i32(file, resource_manager.priority_inheritance);
+    put_i32(file, resource_manager.count);
+    for (int r = 0; r < resource_manager.count; r++) {
+        Mutex* mutex = &resource_manager.mutexes[r];
+        put_str(file, mutex->name);
+        put_i32(file, mutex->initial_count);
+        put_i32(file, mutex->available);
+        put_index_list(file, &table, mutex->holders, mutex->holder_count);
+        for (int level = 0; level < WAIT_LEVELS; level++) {
+            int count = 0;
+            for (PCB* pcb = mutex->wait_head[level]; pcb; pcb = pcb->wait_next) count++;
+            put_i32(file, count);
+            for (PCB* pcb = mutex->wait_head[level]; pcb; pcb = pcb->wait_next) {
+                put_i32(file, index_of(&table, pcb));
+            }
+        }
+    }
+
+    int input_count = 0;
+    const InputRequest* inputs = input_requests(&input_count);
+    put_i32(file, input_count);
+    for (int i = 0; i < input_count; i++) {
+        put_i32(file, index_of(&table, inputs[i].pcb));
+        put_str(file, inputs[i].variable);
+        put_str(file, inputs[i].prompt);
+        put_i32(file, inputs[i].answered);
+        put_str(file, inputs[i].answer);
+    }
+
+    put_i32(file, INSTR_UNKNOWN + 1);
+    for (int t = 0; t <= INSTR_UNKNOWN; t++) put_i32(file, instruction_cost((InstructionType)t));
+    Device devices[DEVICE_COUNT];
+    device_snapshot(devices);
+    put_i32(file, DEVICE_COUNT);
+    for (int i = 0; i < DEVICE_COUNT; i++) {
+        put_i32(file, devices[i].service_time);
+        put_i32(file, devices[i].busy_until);
+        put_i64(file, devices[i].operations);
+        put_i64(file, devices[i].busy_cycles);
+        put_i64(file, devices[i].queue_cycles);
+        put_i32(file, devices[i].max_queue);
+    }
+
+    // Buffered and in-memory files are not on disk yet; the cache goes along with them
+    VfsFileImage* images = NULL;
+    int image_count = vfs_snapshot(&images);
+    if (image_count < 0) {
+        fprintf(stderr, "Failed to copy the file cache!\n");
+        exit(EXIT_FAILURE);
+    }
+    VfsStats vfs_stats = vfs_get_stats();
+    put_i32(file, vfs_get_mode());
+    put_i64(file, vfs_stats.reads);
+    put_i64(file, vfs_stats.writes);
+    put_i64(file, vfs_stats.cache_hits);
+    put_i64(file, vfs_stats.disk_reads);
+    put_i64(file, vfs_stats.disk_writes);
+    put_i64(file, vfs_stats.opens);
+    put_i32(file, image_count);
+    for (int i = 0; i < image_count; i++) {
+        put_str(file, images[i].path);
+        put_i32(file, images[i].dirty);
+        put_i64(file, (int64_t)images[i].length);
+        fwrite(images[i].data, 1, images[i].length, file);
+    }
+    vfs_free_images(images, image_count);
+
+    // Scripted input: queued answers, then the script file and how far it has been read
+    char* const* answers = NULL;
+    const char* script_path = NULL;
+    long script_offset = -1;
+    int answer_count = input_script_state(&answers, &script_path, &script_offset);
+    put_i32(file, answer_count);
+    for (int i = 0; i < answer_count; i++) put_str(file, answers[i]);
+    put_str(file, script_path);
+    put_i64(file, script_offset);
+
+    put_i32(file, (int32_t)CHECKPOINT_END);
+    printf("[CHECKPOINT] Wrote %d process(es) at clock %d\n", table.count, scheduler->clock_cycle);
+    free(table.items);
+}
+
+int checkpoint_save(Scheduler* scheduler, const char* path) {
+    if (!scheduler || !path) return -1;
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("[ERROR] Cannot open checkpoint %s for writing\n", path);
+        return -1;
+    }
+    setvbuf(file, NULL, _IOFBF, CHECKPOINT_IO_BUFFER);
+
+    scheduler_lock();
+    write_checkpoint(scheduler, file);
+    scheduler_unlock();
+
+    int failed = ferror(file);
+    if (fclose(file) != 0) failed = 1;
+    if (failed) {
+        printf("[ERROR] Failed writing checkpoint %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------- reading
+
+typedef struct {
+    FILE* file;
+    int failed;
+    int version;
+} Reader;
+
+static int32_t get_i32(Reader* reader) {
+    int32_t value = 0;
+    if (!reader->failed && fread(&value, sizeof(value), 1, reader->file) != 1) reader->failed = 1;
+    return value;
+}
+
+static int64_t get_i64(Reader* reader) {
+    int64_t value = 0;
+    if (!reader->failed && fread(&value, sizeof(value), 1, reader->file) != 1) reader->failed = 1;
+    return value;
+}
+
+// Heap copy of the next string, NULL for a stored NULL or on error
+static char* get_str(Reader* reader) {
+    int32_t length = get_i32(reader);
+    if (reader->failed || length < 0) return NULL;
+    if (length > CHECKPOINT_MAX_STRING) {
+        reader->failed = 1;
+        return NULL;
+    }
+    char* value = malloc(length + 1);
+    if (!value || fread(value, 1, length, reader->file) != (size_t)length) {
+        free(value);
+        reader->failed = 1;
+        return NULL;
+    }
+    value[length] = '\0';
+    return value;
+}
+
+// Reads the next string into a fixed-size field
+static void get_str_into(Reader* reader, char* buffer, size_t size) {
+    char* value = get_str(reader);
+    snprintf(buffer, size, "%s", value ? value : "");
+    free(value);
+}
+
+// Counts are bounded so a corrupt file fails cleanly instead of allocating wildly
+static int get_count(Reader* reader, int limit) {
+    int32_t count = get_i32(reader);
+    if (count < 0 || count > limit) reader->failed = 1;
+    return reader->failed ? 0 : count;
+}
+
+typedef struct {
+    int* items;
+    int count;
+} IndexList;
+
+static void get_index_list(Reader* reader, IndexList* list, int process_count) {
+    list->count = get_count(reader, process_count);
+    list->items = list->count > 0 ? malloc(list->count * sizeof(int)) : NULL;
+    if (list->count > 0 && !list->items) {
+        reader->failed = 1;
+        list->count = 0;
+        return;
+    }
+    for (int i = 0; i < list->count; i++) {
+        list->items[i] = get_i32(reader);
+        if (list->items[i] < 0 || list->items[i] >= process_count) reader->failed = 1;
+    }
+}
+
+typedef struct {
+    long long busy_cycles;
+    long long idle_cycles;
+    int dispatches;
+    int migrations;
+    int steals;
+    int running;
+    IndexList ready[4];
+    long long min_vruntime;
+    IndexList cfs;
+} StagedCpu;
+
+typedef struct {
+    char name[MAX_RESOURCE_NAME];
+    int initial_count;
+    int available;
+    IndexList holders;
+    IndexList waiters[WAIT_LEVELS];
+} StagedResource;
+
+typedef struct {
+    int process;
+    char variable[64];
+    char prompt[MAX_INPUT_PROMPT];
+    int answered;
+    char answer[MAX_INPUT_VALUE];
+} StagedInput;
+
+// Everything read from the file, kept aside until the whole file has been validated
+typedef struct {
+    int algorithm;
+    int quantum;
+    int num_cpus;
+    int work_stealing;
+    int parallel;
+    int event_driven;
+    int min_granularity;
+    int target_latency;
+    int boost_period;
+    int aging_threshold[4];
+    int starvation_threshold;
+    int instructions_per_cycle;
+    int clock_cycle;
+    int next_pid;
+    SchedulerMetrics metrics;
+    PCB** processes;
+    int process_count;
+    StagedCpu cpus[MAX_CPUS];
+    IndexList blocked;
+    IndexList pending;
+    MemoryWord words[MEMORY_SIZE];
+    int next_free_word;
+    TextSegment segments[MAX_TEXT_SEGMENTS];
+    int segment_count;
+    int deadlock_policy;
+    int priority_inheritance;
+    StagedResource* resources;
+    int resource_count;
+    StagedInput* inputs;
+    int input_count;
+    int instruction_costs[INSTR_UNKNOWN + 1];
+    Device devices[DEVICE_COUNT];
+    bool has_files;                // older files leave the file cache alone
+    int vfs_mode;
+    VfsStats vfs_stats;
+    VfsFileImage* files;
+    int file_count;
+    bool has_script;               // older files leave the scripted input feed alone
+    char** answers;
+    int answer_count;
+    char* script_path;
+    long long script_offset;
+} Checkpoint;
+
+static void free_staged(Checkpoint* ckpt, bool free_processes) {
+    if (free_processes) {
+        for (int i = 0; i < ckpt->process_count; i++) destroy_pcb(ckpt->processes[i]);
+        for (int i = 0; i < MEMORY_SIZE; i++) {
+            free(ckpt->words[i].name);
+            free(ckpt->words[i].data);
+        }
+    }
+    free(ckpt->processes);
+    for (int c = 0; c < MAX_CPUS; c++) {
+        for (int i = 0; i < 4; i++) free(ckpt->cpus[c].ready[i].items);
+        free(ckpt->cpus[c].cfs.items);
+    }
+    free(ckpt->blocked.items);
+    free(ckpt->pending.items);
+    for (int r = 0; r < ckpt->resource_count; r++) {
+        free(ckpt->resources[r].holders.items);
+        for (int level = 0; level < WAIT_LEVELS; level++) free(ckpt->resources[r].waiters[level].items);
+    }
+    free(ckpt->resources);
+    free(ckpt->inputs);
+    vfs_free_images(ckpt->files, ckpt->file_count);
+    for (int i = 0; i < ckpt->answer_count; i++) free(ckpt->answers[i]);
+    free(ckpt->answers);
+    free(ckpt->script_path);
+    free(ckpt);
+}
+
+static void read_metrics(Reader* reader, SchedulerMetrics* metrics) {
+    metrics->dispatches = get_i64(reader);
+    metrics->boosts = get_i64(reader);
+    metrics->promotions = get_i64(reader);
+    metrics->demotions = get_i64(reader);
+    metrics->starvation_alarms = get_i64(reader);
+    metrics->total_ready_wait = get_i64(reader);
+    metrics->max_ready_wait = get_i32(reader);
+    metrics->max_ready_wait_pid = get_i32(reader);
+    metrics->deadlocks = get_i64(reader);
+    metrics->deadlock_recoveries = get_i64(reader);
+    metrics->inheritance_boosts = get_i64(reader);
+    metrics->inversion_cycles = get_i64(reader);
+    metrics->idle_cycles = get_i64(reader);
+    metrics->skipped_cycles = get_i64(reader);
+    metrics->timeouts = reader->version >= 6 ? get_i64(reader) : 0;
+}
+
+// Builds the PCB directly rather than through the setters, which log every change
+static PCB* get_pcb(Reader* reader) {
+    int pid = get_i32(reader);
+    PCB* pcb = create_pcb(pid, 0);
+    if (!pcb) {
+        reader->failed = 1;
+        return NULL;
+    }
+    pcb->state = (ProcessState)get_i32(reader);
+    pcb->priority = get_i32(reader);
+    pcb->base_priority = get_i32(reader);
+    pcb->inherited_priority = get_i32(reader);
+    pcb->program_counter = get_i32(reader);
+    pcb->memory_lower_bound = get_i32(reader);
+    pcb->memory_upper_bound = get_i32(reader);
+    pcb->arrival_time = get_i32(reader);
+    pcb->quantum_remaining = get_i32(reader);
+    // Waits are stored as lengths; the restored scheduler's aging clock starts at 0
+    pcb->queued_at = -get_i32(reader);
+    pcb->ready_since = -get_i32(reader);
+    pcb->starving = get_i32(reader);
+    pcb->last_cpu = get_i32(reader);
+    pcb->queued_cpu = get_i32(reader);
+    pcb->waiting_on = get_i32(reader);
+    pcb->granted_resource = get_i32(reader);
+    pcb->io_wait = reader->version >= 2 ? get_i32(reader) : 0;
+    pcb->text_base = reader->version >= 3 ? get_i32(reader) : -1;
+    if (reader->version >= 5) {
+        pcb->device_wait = get_i32(reader);
+        pcb->wake_cycle = get_i32(reader);
+        pcb->stall_cycles = get_i32(reader);
+        if (pcb->device_wait < -1 || pcb->device_wait >= DEVICE_COUNT || pcb->stall_cycles < 0) reader->failed = 1;
+    }
+    if (reader->version >= 6) {
+        // Re-armed once the whole checkpoint has been read
+        pcb->timer.kind = get_i32(reader);
+        pcb->timer.expires = get_i32(reader);
+        if (pcb->timer.kind != TIMER_NONE && pcb->timer.kind != TIMER_SLEEP && pcb->timer.kind != TIMER_SEM_TIMEOUT) reader->failed = 1;
+    }
+    pcb->nice = get_i32(reader);
+    pcb->weight = cfs_weight_for_nice(pcb->nice);
+    pcb->affinity_mask = (uint64_t)get_i64(reader);
+    pcb->vruntime = get_i64(reader);
+    get_str_into(reader, pcb->program_name, sizeof(pcb->program_name));
+
+    int instruction_count = get_count(reader, CHECKPOINT_MAX_STRING);
+    if (instruction_count > 0) {
+        pcb->instructions = calloc(instruction_count, sizeof(char*));
+        pcb->resource_ids = malloc(instruction_count * sizeof(int));
+        if (!pcb->instructions || !pcb->resource_ids) reader->failed = 1;
+    }
+    for (int i = 0; i < instruction_count && !reader->failed; i++) {
+        pcb->instructions[i] = get_str(reader);
+        pcb->resource_ids[i] = get_i32(reader);
+        pcb->instruction_count = i + 1;
+    }
+
+    int var_count = get_count(reader, CHECKPOINT_MAX_STRING);
+    if (var_count > 0) {
+        pcb->variables = calloc(var_count, sizeof(char*));
+        pcb->values = calloc(var_count, sizeof(char*));
+        if (!pcb->variables || !pcb->values) reader->failed = 1;
+    }
+    for (int i = 0; i < var_count && !reader->failed; i++) {
+        pcb->variables[i] = get_str(reader);
+        pcb->values[i] = get_str(reader);
+        pcb->var_count = i + 1;
+    }
+    return pcb;
+}
+
+static bool read_checkpoint(Reader* reader, Checkpoint* ckpt) {
+    char magic[8];
+    if (fread(magic, 1, sizeof(magic), reader->file) != sizeof(magic) ||
+        memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        printf("[ERROR] Not a checkpoint file\n");
+        return false;
+    }
+    reader->version = get_i32(reader);
+    if (reader->version < 1 || reader->version > CHECKPOINT_VERSION) {
+        printf("[ERROR] Unsupported checkpoint version %d (this build reads up to %d)\n", reader->version, CHECKPOINT_VERSION);
+        return false;
+    }
+    if ((uint32_t)get_i32(reader) != CHECKPOINT_BYTE_ORDER) {
+        printf("[ERROR] Checkpoint was written with a different byte order\n");
+        return false;
+    }
+
+    ckpt->algorithm = get_i32(reader);
+    ckpt->quantum = get_i32(reader);
+    ckpt->num_cpus = get_i32(reader);
+    ckpt->work_stealing = get_i32(reader);
+    ckpt->parallel = get_i32(reader);
+    ckpt->event_driven = get_i32(reader);
+    ckpt->min_granularity = get_i32(reader);
+    ckpt->target_latency = get_i32(reader);
+    ckpt->boost_period = get_i32(reader);
+    for (int i = 0; i < 4; i++) ckpt->aging_threshold[i] = get_i32(reader);
+    ckpt->starvation_threshold = get_i32(reader);
+    ckpt->instructions_per_cycle = reader->version >= 4 ? get_i32(reader) : 1;
+    ckpt->clock_cycle = get_i32(reader);
+    ckpt->next_pid = get_i32(reader);
+    read_metrics(reader, &ckpt->metrics);
+    if (ckpt->algorithm < FCFS || ckpt->algorithm > CFS || ckpt->num_cpus < 1 || ckpt->num_cpus > MAX_CPUS) {
+        reader->failed = 1;
+    }
+
+    ckpt->process_count = get_count(reader, CHECKPOINT_MAX_PROCESSES);
+    if (ckpt->process_count > 0) {
+        ckpt->processes = calloc(ckpt->process_count, sizeof(PCB*));
+        if (!ckpt->processes) return false;
+    }
+    for (int i = 0; i < ckpt->process_count; i++) {
+        PCB* pcb = get_pcb(reader);
+        if (!pcb) break;
+        ckpt->processes[i] = pcb;
+        if (reader->failed) {
+            ckpt->process_count = i + 1;
+            return false;
+        }
+    }
+    if (reader->failed) return false;
+
+    int n = ckpt->process_count;
+    for (int c = 0; c < ckpt->num_cpus; c++) {
+        StagedCpu* cpu = &ckpt->cpus[c];
+        cpu->busy_cycles = get_i64(reader);
+        cpu->idle_cycles = get_i64(reader);
+        cpu->dispatches = get_i32(reader);
+        cpu->migrations = get_i32(reader);
+        cpu->steals = get_i32(reader);
+        cpu->running = get_i32(reader);
+        if (cpu->running < -1 || cpu->running >= n) reader->failed = 1;
+        for (int i = 0; i < 4; i++) get_index_list(reader, &cpu->ready[i], n);
+        cpu->min_vruntime = get_i64(reader);
+        get_index_list(reader, &cpu->cfs, n);
+    }
+    get_index_list(reader, &ckpt->blocked, n);
+    get_index_list(reader, &ckpt->pending, n);
+
+    if (get_i32(reader) != MEMORY_SIZE) {
+        printf("[ERROR] Checkpoint memory size does not match this build\n");
+        return false;
+    }
+    ckpt->next_free_word = get_i32(reader);
+    for (int i = 0; i < MEMORY_SIZE; i++) {
+        ckpt->words[i].process_id = get_i32(reader);
+        ckpt->words[i].name = get_str(reader);
+        ckpt->words[i].data = get_str(reader);
+    }
+    if (reader->version >= 3) {
+        ckpt->segment_count = get_count(reader, MAX_TEXT_SEGMENTS);
+        for (int i = 0; i < ckpt->segment_count; i++) {
+            TextSegment* segment = &ckpt->segments[i];
+            segment->key = NULL;
+            segment->base = get_i32(reader);
+            segment->size = get_i32(reader);
+            segment->refs = get_i32(reader);
+            if (segment->base < 0 || segment->size <= 0 || segment->base + segment->size > MEMORY_SIZE) {
+                reader->failed = 1;
+            }
+        }
+    }
+
+    ckpt->deadlock_policy = get_i32(reader);
+    ckpt->priority_inheritance = get_i32(reader);
+    ckpt->resource_count = get_count(reader, 1 << 20);
+    if (ckpt->resource_count < NUM_BUILTIN_RESOURCES) reader->failed = 1;
+    if (reader->failed) return false;
+    ckpt->resources = calloc(ckpt->resource_count, sizeof(StagedResource));
+    if (!ckpt->resources) return false;
+    for (int r = 0; r < ckpt->resource_count && !reader->failed; r++) {
+        StagedResource* resource = &ckpt->resources[r];
+        get_str_into(reader, resource->name, sizeof(resource->name));
+        resource->initial_count = get_i32(reader);
+        resource->available = get_i32(reader);
+        get_index_list(reader, &resource->holders, n);
+        for (int level = 0; level < WAIT_LEVELS; level++) {
+            get_index_list(reader, &resource->waiters[level], n);
+        }
+    }
+
+    ckpt->input_count = get_count(reader, n);
+    if (ckpt->input_count > 0 && !reader->failed) {
+        ckpt->inputs = calloc(ckpt->input_count, sizeof(StagedInput));
+        if (!ckpt->inputs) return false;
+    }
+    for (int i = 0; i < ckpt->input_count && !reader->failed; i++) {
+        StagedInput* input = &ckpt->inputs[i];
+        input->process = get_i32(reader);
+        if (input->process < 0 || input->process >= n) reader->failed = 1;
+        get_str_into(reader, input->variable, sizeof(input->variable));
+        get_str_into(reader, input->prompt, sizeof(input->prompt));
+        input->answered = get_i32(reader);
+        get_str_into(reader, input->answer, sizeof(input->answer));
+    }
+
+    // Older files predate the cost model: every instruction one cycle, devices instantaneous
+    for (int t = 0; t <= INSTR_UNKNOWN; t++) ckpt->instruction_costs[t] = 1;
+    if (reader->version >= 5) {
+        // The last entry is always INSTR_UNKNOWN; types this build lacks are skipped, missing ones keep one cycle
+        int cost_count = get_count(reader, 1 << 10);
+        for (int t = 0; t < cost_count && !reader->failed; t++) {
+            int cost = get_i32(reader);
+            if (t == cost_count - 1) ckpt->instruction_costs[INSTR_UNKNOWN] = cost;
+            else if (t < INSTR_UNKNOWN) ckpt->instruction_costs[t] = cost;
+        }
+        if (get_i32(reader) != DEVICE_COUNT) reader->failed = 1;
+        for (int i = 0; i < DEVICE_COUNT && !reader->failed; i++) {
+            Device* device = &ckpt->devices[i];
+            device->service_time = get_i32(reader);
+            device->busy_until = get_i32(reader);
+            device->operations = get_i64(reader);
+            device->busy_cycles = get_i64(reader);
+            device->queue_cycles = get_i64(reader);
+            device->max_queue = get_i32(reader);
+        }
+    }
+
+    if (reader->version >= 7) {
+        ckpt->has_files = true;
+        ckpt->vfs_mode = get_i32(reader);
+        if (ckpt->vfs_mode < VFS_WRITE_THROUGH || ckpt->vfs_mode > VFS_MEMORY) reader->failed = 1;
+        VfsStats* stats = &ckpt->vfs_stats;
+        stats->reads = get_i64(reader);
+        stats->writes = get_i64(reader);
+        stats->cache_hits = get_i64(reader);
+        stats->disk_reads = get_i64(reader);
+        stats->disk_writes = get_i64(reader);
+        stats->opens = get_i64(reader);
+        int count = get_count(reader, CHECKPOINT_MAX_PROCESSES);
+        ckpt->files = count > 0 ? calloc(count, sizeof(VfsFileImage)) : NULL;
+        if (count > 0 && !ckpt->files) reader->failed = 1;
+        for (int i = 0; i < count && !reader->failed; i++) {
+            VfsFileImage* image = &ckpt->files[i];
+            ckpt->file_count++;
+            image->path = get_str(reader);
+            image->dirty = get_i32(reader) != 0;
+            int64_t length = get_i64(reader);
+            if (!image->path || length < 0 || length > CHECKPOINT_MAX_FILE_BYTES) {
+                reader->failed = 1;
+                break;
+            }
+            image->length = (size_t)length;
+            image->data = malloc(image->length + 1);
+            if (!image->data || fread(image->data, 1, image->length, reader->file) != image->length) {
+                reader->failed = 1;
+                break;
+            }
+            image->data[image->length] = '\0';
+        }
+    }
+
+    if (reader->version >= 8) {
+        ckpt->has_script = true;
+        int count = get_count(reader, CHECKPOINT_MAX_PROCESSES);
+        ckpt->answers = count > 0 ? calloc(count, sizeof(char*)) : NULL;
+        if (count > 0 && !ckpt->answers) reader->failed = 1;
+        for (int i = 0; i < count && !reader->failed; i++) {
+            ckpt->answers[ckpt->answer_count++] = get_str(reader);
+            if (!ckpt->answers[i]) reader->failed = 1;
+        }
+        ckpt->script_path = get_str(reader);
+        ckpt->script_offset = get_i64(reader);
+    }
+
+    if ((uint32_t)get_i32(reader) != CHECKPOINT_END) reader->failed = 1;
+    return !reader->failed;
+}
+
+// ---------------------------------------------------------------- installing
+
+static void fill_queue(ProcessQueue* queue, const IndexList* list, PCB** processes) {
+    free(queue->processes);
+    queue->capacity = list->count > 0 ? list->count : 1;
+    queue->processes = malloc(queue->capacity * sizeof(PCB*));
+    for (int i = 0; i < list->count; i++) {
+        queue->processes[i] = processes[list->items[i]];
+    }
+    queue->size = list->count;
+}
+
+// Replace the live simulation with the staged one; the old PCBs are freed
+static void install_checkpoint(Scheduler* scheduler, Checkpoint* ckpt) {
+    PCB** processes = ckpt->processes;
+
+    PcbTable old = {NULL, 0, 0};
+    collect_processes(scheduler, &old);
+
+    destroy_scheduler(scheduler);
+    init_scheduler(scheduler, (SchedulingAlgorithm)ckpt->algorithm, ckpt->quantum);
+    scheduler->num_cpus = ckpt->num_cpus;
+    scheduler->work_stealing = ckpt->work_stealing;
+    scheduler->parallel = ckpt->parallel;
+    scheduler->event_driven = ckpt->event_driven;
+    scheduler->min_granularity = ckpt->min_granularity;
+    scheduler->target_latency = ckpt->target_latency;
+    scheduler->boost_period = ckpt->boost_period;
+    memcpy(scheduler->aging_threshold, ckpt->aging_threshold, sizeof(ckpt->aging_threshold));
+    scheduler->starvation_threshold = ckpt->starvation_threshold;
+    scheduler->instructions_per_cycle = ckpt->instructions_per_cycle < 1 ? 1 : ckpt->instructions_per_cycle;
+    scheduler->clock_cycle = ckpt->clock_cycle;
+    scheduler->next_pid = ckpt->next_pid;
+    scheduler->metrics = ckpt->metrics;
+
+    for (int c = 0; c < ckpt->num_cpus; c++) {
+        StagedCpu* staged = &ckpt->cpus[c];
+        Cpu* cpu = &scheduler->cpus[c];
+        cpu->busy_cycles = staged->busy_cycles;
+        cpu->idle_cycles = staged->idle_cycles;
+        cpu->dispatches = staged->dispatches;
+        cpu->migrations = staged->migrations;
+        cpu->steals = staged->steals;
+        cpu->running_process = staged->running >= 0 ? processes[staged->running] : NULL;
+        for (int i = 0; i < 4; i++) {
+            fill_queue(&cpu->ready_queues[i], &staged->ready[i], processes);
+        }
+        cpu->cfs_queue.min_vruntime = staged->min_vruntime;
+        for (int i = 0; i < staged->cfs.count; i++) {
+            cfs_enqueue(&cpu->cfs_queue, processes[staged->cfs.items[i]]);
+        }
+    }
+    fill_queue(&scheduler->blocked_queue, &ckpt->blocked, processes);
+    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
+        scheduler->blocked_queue.processes[i]->blocked_index = i;
+    }
+
+    free(pending_list.list);
+    pending_list.capacity = ckpt->pending.count > 0 ? ckpt->pending.count : 0;
+    pending_list.list = pending_list.capacity > 0 ? malloc(pending_list.capacity * sizeof(PCB*)) : NULL;
+    for (int i = 0; i < ckpt->pending.count; i++) {
+        pending_list.list[i] = processes[ckpt->pending.items[i]];
+    }
+    pending_list.count = ckpt->pending.count;
+
+    for (int i = 0; i < MEMORY_SIZE; i++) {
+        free(memory.words[i].name);
+        free(memory.words[i].data);
+        memory.words[i] = ckpt->words[i];
+    }
+    memory.next_free_word = ckpt->next_free_word;
+    // Restored text is no longer tied to a cached program, so new loads map their own copy
+    memcpy(memory.segments, ckpt->segments, sizeof(ckpt->segments));
+    memory.segment_count = ckpt->segment_count;
+
+    destroy_resource_manager(&resource_manager);
+    init_resource_manager(&resource_manager);
+    resource_manager.deadlock_policy = (DeadlockPolicy)ckpt->deadlock_policy;
+    resource_manager.priority_inheritance = ckpt->priority_inheritance;
+    for (int r = NUM_BUILTIN_RESOURCES; r < ckpt->resource_count; r++) {
+        register_resource(&resource_manager, ckpt->resources[r].name, ckpt->resources[r].initial_count);
+    }
+    for (int r = 0; r < ckpt->resource_count && r < resource_manager.count; r++) {
+        StagedResource* staged = &ckpt->resources[r];
+        Mutex* mutex = &resource_manager.mutexes[r];
+        free(mutex->holders);
+        mutex->holder_capacity = staged->holders.count > 0 ? staged->holders.count : 1;
+        mutex->holders = malloc(mutex->holder_capacity * sizeof(PCB*));
+        for (int h = 0; h < staged->holders.count; h++) {
+            mutex->holders[h] = processes[staged->holders.items[h]];
+        }
+        mutex->holder_count = staged->holders.count;
+        mutex->available = staged->available;
+        mutex->locked = mutex->available == 0;
+        mutex->owner_pid = mutex->holder_count > 0 ? mutex->holders[0]->pid : -1;
+        for (int level = 0; level < WAIT_LEVELS; level++) {
+            const IndexList* waiters = &staged->waiters[level];
+            for (int i = 0; i < waiters->count; i++) {
+                PCB* pcb = processes[waiters->items[i]];
+                pcb->wait_level = level;
+                pcb->wait_next = NULL;
+                pcb->wait_prev = mutex->wait_tail[level];
+                if (mutex->wait_tail[level]) mutex->wait_tail[level]->wait_next = pcb;
+                else mutex->wait_head[level] = pcb;
+                mutex->wait_tail[level] = pcb;
+                mutex->wait_bitmap |= 1u << level;
+                mutex->queue_size++;
+            }
+        }
+    }
+    invalidate_priority_inversions();
+
+    // In-flight file I/O is not saved; those processes run their readFile/writeFile again
+    aio_reset();
+    // Walks backwards: a removal moves the last entry, already seen, into the freed slot
+    for (int i = scheduler->blocked_queue.size - 1; i >= 0; i--) {
+        PCB* pcb = scheduler->blocked_queue.processes[i];
+        if (!pcb->io_wait) continue;
+        remove_from_blocked_queue(scheduler, pcb);
+        pcb->io_wait = 0;
+        add_process(scheduler, pcb);
+    }
+
+    for (int t = 0; t <= INSTR_UNKNOWN; t++) {
+        set_instruction_cost((InstructionType)t, ckpt->instruction_costs[t]);
+    }
+    device_restore(ckpt->devices);
+    if (ckpt->has_files) {
+        vfs_restore((VfsMode)ckpt->vfs_mode, &ckpt->vfs_stats, ckpt->files, ckpt->file_count);
+    }
+    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
+        device_add_waiter(scheduler->blocked_queue.processes[i]);
+    }
+    // Sleeps and semWait timeouts pick up where they were
+    timer_reset(scheduler->clock_cycle);
+    for (int i = 0; i < ckpt->process_count; i++) {
+        PCB* pcb = processes[i];
+        if (pcb->timer.kind != TIMER_NONE) timer_arm(&pcb->timer, pcb->timer.expires);
+    }
+
+    input_reset();
+    if (ckpt->has_script) {
+        input_restore_script(ckpt->answers, ckpt->answer_count, ckpt->script_path, (long)ckpt->script_offset);
+    }
+    for (int i = 0; i < ckpt->input_count; i++) {
+        StagedInput* input = &ckpt->inputs[i];
+        input_restore_request(processes[input->process], input->variable, input->prompt,
+                              input->answered != 0, input->answer);
+    }
+
+    for (int i = 0; i < old.count; i++) {
+        destroy_pcb(old.items[i]);
+    }
+    free(old.items);
+}
+
+int checkpoint_load(Scheduler* scheduler, const char* path) {
+    if (!scheduler || !path) return -1;
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("[ERROR] Cannot open checkpoint %s\n", path);
+        return -1;
+    }
+    setvbuf(file, NULL, _IOFBF, CHECKPOINT_IO_BUFFER);
+
+    Checkpoint* ckpt = calloc(1, sizeof(Checkpoint));
+    if (!ckpt) {
+        fclose(file);
+        return -1;
+    }
+    Reader reader = {file, 0, 0};
+    bool ok = read_checkpoint(&reader, ckpt);
+    fclose(file);
+    if (!ok) {
+        printf("[ERROR] Checkpoint %s is truncated or corrupt; simulation left unchanged\n", path);
+        free_staged(ckpt, true);
+        return -1;
+    }
+
+    scheduler_lock();
+    install_checkpoint(scheduler, ckpt);
+    scheduler_unlock();
+    printf("[CHECKPOINT] Restored %d process(es) at clock %d\n", ckpt->process_count, scheduler->clock_cycle);
+    free_staged(ckpt, false);
+    return 0;
+}
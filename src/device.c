@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "device.h"
+#include "globals.h"
+#include "queue.h"
+
+#define INITIAL_WAITER_CAPACITY 16
+
+// A process blocked until its device operation completes
+typedef struct {
+    PCB* pcb;
+    int wake_cycle;
+} DeviceWaiter;
+
+// Operations are issued from whichever CPU thread runs the instruction
+static pthread_mutex_t device_lock = PTHREAD_MUTEX_INITIALIZER;
+static Device devices[DEVICE_COUNT];
+static DeviceWaiter* waiters = NULL;
+static int waiter_count = 0;
+static int waiter_capacity = 0;
+
+static const char* device_names[DEVICE_COUNT] = {"disk", "console"};
+
+const char* device_name(DeviceId id) {
+    return id >= 0 && id < DEVICE_COUNT ? device_names[id] : "unknown";
+}
+
+// DEVICE_COUNT if name is not a device
+DeviceId device_by_name(const char* name) {
+    for (int i = 0; name && i < DEVICE_COUNT; i++) {
+        if (strcmp(name, device_names[i]) == 0) return (DeviceId)i;
+    }
+    return DEVICE_COUNT;
+}
+
+void device_set_service_time(DeviceId id, int cycles) {
+    if (id < 0 || id >= DEVICE_COUNT) return;
+    pthread_mutex_lock(&device_lock);
+    devices[id].service_time = cycles > 0 ? cycles : 0;
+    pthread_mutex_unlock(&device_lock);
+    printf("[DEVICE] %s service time %d cycle(s)\n", device_names[id], cycles > 0 ? cycles : 0);
+}
+
+bool device_is_timed(DeviceId id) {
+    return id >= 0 && id < DEVICE_COUNT && devices[id].service_time > 0;
+}
+
+static int reserve_locked(Device* device, int now) {
+    int start = device->busy_until > now ? device->busy_until : now;
+    int queued = device->service_time > 0 ? (start - now + device->service_time - 1) / device->service_time : 0;
+    if (queued + 1 > device->max_queue) device->max_queue = queued + 1;
+    device->queue_cycles += start - now;
+    device->busy_cycles += device->service_time;
+    device->operations++;
+    device->busy_until = start + device->service_time;
+    return device->busy_until;
+}
+
+// Queue one operation issued at cycle now; returns the cycle at which it completes
+int device_reserve(DeviceId id, int now) {
+    if (id < 0 || id >= DEVICE_COUNT) return now;
+    pthread_mutex_lock(&device_lock);
+    int done = reserve_locked(&devices[id], now);
+    pthread_mutex_unlock(&device_lock);
+    return done;
+}
+
+static void add_waiter_locked(PCB* pcb) {
+    if (waiter_count == waiter_capacity) {
+        int capacity = waiter_capacity ? waiter_capacity * 2 : INITIAL_WAITER_CAPACITY;
+        DeviceWaiter* grown = realloc(waiters, capacity * sizeof(DeviceWaiter));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow device wait list!\n");
+            exit(EXIT_FAILURE);
+        }
+        waiters = grown;
+        waiter_capacity = capacity;
+    }
+    waiters[waiter_count].pcb = pcb;
+    waiters[waiter_count].wake_cycle = pcb->wake_cycle;
+    waiter_count++;
+}
+
+// Issue an operation for pcb and block it until the device completes it.
+// False (and nothing happens) if the device is instantaneous.
+bool device_block(PCB* pcb, DeviceId id) {
+    if (!pcb || !device_is_timed(id)) return false;
+    int now = scheduler->clock_cycle;
+    pthread_mutex_lock(&device_lock);
+    pcb->wake_cycle = reserve_locked(&devices[id], now);
+    pcb->device_wait = id;
+    add_waiter_locked(pcb);
+    pthread_mutex_unlock(&device_lock);
+
+    scheduler_lock();
+    set_pcb_state(pcb, BLOCKED);
+    add_to_blocked_queue(scheduler, pcb);
+    scheduler_unlock();
+    printf("[DEVICE] PID %d waits on %s until cycle %d\n", pcb->pid, device_names[id], pcb->wake_cycle);
+    return true;
+}
+
+// Track a PCB that is already blocked on a device (checkpoint restore)
+void device_add_waiter(PCB* pcb) {
+    if (!pcb || pcb->device_wait < 0) return;
+    pthread_mutex_lock(&device_lock);
+    add_waiter_locked(pcb);
+    pthread_mutex_unlock(&device_lock);
+}
+
+// Once per cycle: unblock every process whose operation has completed. Returns how many were woken.
+int device_deliver(Scheduler* scheduler) {
+    if (!scheduler) return 0;
+    PCB* woken[64];
+    int delivered = 0;
+    bool more = true;
+    while (more) {
+        int count = 0;
+        more = false;
+        pthread_mutex_lock(&device_lock);
+        for (int i = 0; i < waiter_count; ) {
+            if (waiters[i].wake_cycle > scheduler->clock_cycle) {
+                i++;
+                continue;
+            }
+            if (count == (int)(sizeof(woken) / sizeof(woken[0]))) {
+                more = true;
+                break;
+            }
+            woken[count++] = waiters[i].pcb;
+            waiters[i] = waiters[--waiter_count];
+        }
+        pthread_mutex_unlock(&device_lock);
+
+        // A process killed while it waited is no longer in the blocked queue; leave it alone
+        scheduler_lock();
+        for (int i = 0; i < count; i++) {
+            PCB* pcb = woken[i];
+            if (!remove_from_blocked_queue(scheduler, pcb)) continue;
+            printf("[DEVICE] %s operation for PID %d completed at cycle %d\n",
+                device_name((DeviceId)pcb->device_wait), pcb->pid, scheduler->clock_cycle);
+            pcb->device_wait = -1;
+            add_process(scheduler, pcb);
+            delivered++;
+        }
+        scheduler_unlock();
+    }
+    return delivered;
+}
+
+// Earliest cycle at which a device operation completes, -1 if none is outstanding
+int device_next_due() {
+    int next = -1;
+    pthread_mutex_lock(&device_lock);
+    for (int i = 0; i < waiter_count; i++) {
+        if (next < 0 || waiters[i].wake_cycle < next) next = waiters[i].wake_cycle;
+    }
+    pthread_mutex_unlock(&device_lock);
+    return next;
+}
+
+void device_snapshot(Device out[DEVICE_COUNT]) {
+    pthread_mutex_lock(&device_lock);
+    memcpy(out, devices, sizeof(devices));
+    pthread_mutex_unlock(&device_lock);
+}
+
+// Replace every device's settings and counters; waiters are re-added with device_add_waiter
+void device_restore(const Device in[DEVICE_COUNT]) {
+    pthread_mutex_lock(&device_lock);
+    memcpy(devices, in, sizeof(devices));
+    waiter_count = 0;
+    pthread_mutex_unlock(&device_lock);
+}
+
+// Drop outstanding operations and counters; service times are settings and stay
+void device_reset() {
+    pthread_mutex_lock(&device_lock);
+    for (int i = 0; i < DEVICE_COUNT; i++) {
+        int service_time = devices[i].service_time;
+        memset(&devices[i], 0, sizeof(Device));
+        devices[i].service_time = service_time;
+    }
+    waiter_count = 0;
+    pthread_mutex_unlock(&device_lock);
+}
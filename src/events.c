@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "events.h"
+#include "globals.h"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+typedef struct {
+    unsigned mask;
+    EventCallback callback;     // NULL = free slot
+    void* user_data;
+} Subscriber;
+
+// Events are emitted from CPU threads as well as the stepping thread
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static Subscriber subscribers[MAX_EVENT_SUBSCRIBERS];
+static unsigned queue_mask = 0;
+static unsigned active_mask = 0;    // every type someone listens to; read without the lock
+static SchedulerEvent* ring = NULL;
+static int ring_head = 0;
+static int ring_count = 0;
+static long long dropped = 0;
+static int event_fd = -1;
+
+static void update_active_mask_locked() {
+    unsigned mask = queue_mask;
+    for (int i = 0; i < MAX_EVENT_SUBSCRIBERS; i++) {
+        if (subscribers[i].callback) mask |= subscribers[i].mask;
+    }
+    __atomic_store_n(&active_mask, mask, __ATOMIC_RELAXED);
+}
+
+static const char* event_type_names[EVENT_TYPE_COUNT] = {
+    "state", "queue", "memory", "log", "clock", "reset", "overflow"
+};
+
+const char* event_type_name(EventType type) {
+    return type >= 0 && type < EVENT_TYPE_COUNT ? event_type_names[type] : "unknown";
+}
+
+bool events_wanted(EventType type) {
+    return (__atomic_load_n(&active_mask, __ATOMIC_RELAXED) & EVENT_MASK(type)) != 0;
+}
+
+// Slot id for events_unsubscribe, -1 if every slot is taken
+int events_subscribe(unsigned mask, EventCallback callback, void* user_data) {
+    if (!callback) return -1;
+    int id = -1;
+    pthread_mutex_lock(&event_lock);
+    for (int i = 0; i < MAX_EVENT_SUBSCRIBERS; i++) {
+        if (subscribers[i].callback) continue;
+        subscribers[i] = (Subscriber){mask & EVENT_MASK_ALL, callback, user_data};
+        id = i;
+        break;
+    }
+    update_active_mask_locked();
+    pthread_mutex_unlock(&event_lock);
+    if (id < 0) printf("[ERROR] No free event subscriber slot (max %d)\n", MAX_EVENT_SUBSCRIBERS);
+    return id;
+}
+
+void events_unsubscribe(int id) {
+    if (id < 0 || id >= MAX_EVENT_SUBSCRIBERS) return;
+    pthread_mutex_lock(&event_lock);
+    subscribers[id].callback = NULL;
+    update_active_mask_locked();
+    pthread_mutex_unlock(&event_lock);
+}
+
+static void clear_fd_locked() {
+#ifdef __linux__
+    uint64_t value;
+    if (event_fd >= 0 && read(event_fd, &value, sizeof(value)) < 0) {
+        // Already clear
+    }
+#endif
+}
+
+static void signal_fd_locked() {
+#ifdef __linux__
+    uint64_t one = 1;
+    if (event_fd >= 0 && write(event_fd, &one, sizeof(one)) < 0) {
+        printf("[WARN] Could not signal the event fd\n");
+    }
+#endif
+}
+
+// Which types go to the event queue; 0 turns it off and discards what is queued
+void events_set_queue_mask(unsigned mask) {
+    pthread_mutex_lock(&event_lock);
+    queue_mask = mask & EVENT_MASK_ALL;
+    if (queue_mask && !ring) {
+        ring = malloc(EVENT_QUEUE_CAPACITY * sizeof(SchedulerEvent));
+        if (!ring) {
+            fprintf(stderr, "Failed to allocate the event queue!\n");
+            exit(EXIT_FAILURE);
+        }
+    } else if (!queue_mask) {
+        free(ring);
+        ring = NULL;
+        ring_head = 0;
+        ring_count = 0;
+        dropped = 0;
+        clear_fd_locked();
+    }
+    update_active_mask_locked();
+    pthread_mutex_unlock(&event_lock);
+}
+
+// Oldest first. After an overflow the first event returned is EVENT_OVERFLOW.
+int events_poll(SchedulerEvent* out, int max) {
+    if (!out || max <= 0) return 0;
+    int count = 0;
+    pthread_mutex_lock(&event_lock);
+    if (dropped > 0) {
+        memset(&out[0], 0, sizeof(SchedulerEvent));
+        out[0].type = EVENT_OVERFLOW;
+        out[0].cycle = scheduler ? scheduler->clock_cycle : 0;
+        out[0].a = dropped > 0x7fffffff ? 0x7fffffff : (int)dropped;
+        dropped = 0;
+        count = 1;
+    }
+    while (count < max && ring_count > 0) {
+        out[count++] = ring[ring_head];
+        ring_head = (ring_head + 1) % EVENT_QUEUE_CAPACITY;
+        ring_count--;
+    }
+    if (ring_count == 0) clear_fd_locked();
+    pthread_mutex_unlock(&event_lock);
+    return count;
+}
+
+// eventfd readable while the queue holds events, -1 where eventfd does not exist
+int events_fd() {
+#ifdef __linux__
+    pthread_mutex_lock(&event_lock);
+    if (event_fd < 0) {
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (event_fd < 0) printf("[ERROR] eventfd() failed\n");
+        else if (ring_count > 0 || dropped > 0) signal_fd_locked();
+    }
+    int fd = event_fd;
+    pthread_mutex_unlock(&event_lock);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+static void push_locked(const SchedulerEvent* event) {
+    if (!ring) return;
+    if (ring_count == EVENT_QUEUE_CAPACITY) {
+        dropped++;
+        return;
+    }
+    ring[(ring_head + ring_count) % EVENT_QUEUE_CAPACITY] = *event;
+    if (ring_count++ == 0 && dropped == 0) signal_fd_locked();
+}
+
+// Queue the event and run the callbacks, outside the lock so they may subscribe or poll
+static void dispatch(const SchedulerEvent* event) {
+    Subscriber targets[MAX_EVENT_SUBSCRIBERS];
+    int count = 0;
+    unsigned bit = EVENT_MASK(event->type);
+    pthread_mutex_lock(&event_lock);
+    if (queue_mask & bit) push_locked(event);
+    for (int i = 0; i < MAX_EVENT_SUBSCRIBERS; i++) {
+        if (subscribers[i].callback && (subscribers[i].mask & bit)) targets[count++] = subscribers[i];
+    }
+    pthread_mutex_unlock(&event_lock);
+    for (int i = 0; i < count; i++) {
+        targets[i].callback(event, targets[i].user_data);
+    }
+}
+
+void event_emit(EventType type, int a, int b, int c) {
+    if (!events_wanted(type)) return;
+    SchedulerEvent event;
+    event.type = type;
+    event.cycle = scheduler ? scheduler->clock_cycle : 0;
+    event.a = a;
+    event.b = b;
+    event.c = c;
+    event.text[0] = '\0';
+    dispatch(&event);
+}
+
+void event_emit_text(EventType type, const char* text) {
+    if (!events_wanted(type)) return;
+    SchedulerEvent event;
+    event.type = type;
+    event.cycle = scheduler ? scheduler->clock_cycle : 0;
+    event.a = 0;
+    event.b = 0;
+    event.c = 0;
+    snprintf(event.text, sizeof(event.text), "%s", text ? text : "");
+    dispatch(&event);
+}
+
+// A forked what-if branch must not wake or call into the parent's frontend
+void events_after_fork() {
+    pthread_mutex_init(&event_lock, NULL);
+    memset(subscribers, 0, sizeof(subscribers));
+    queue_mask = 0;
+    free(ring);
+    ring = NULL;
+    ring_head = 0;
+    ring_count = 0;
+    dropped = 0;
+    if (event_fd >= 0) close(event_fd);
+    event_fd = -1;
+    update_active_mask_locked();
+}
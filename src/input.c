@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "input.h"
+#include "queue.h"
+#include "scheduler.h"
+#include "logger.h"
+
+extern char purpose_msg[256];
+
+// Pending requests in arrival order; guarded by scheduler_lock like the queues they feed
+static InputRequest* requests = NULL;
+static int request_count = 0;
+static int request_capacity = 0;
+
+// Scripted answers: explicit ones are handed out first, then lines of the script file
+static char** scripted = NULL;
+static int scripted_head = 0;
+static int scripted_count = 0;
+static int scripted_capacity = 0;
+static FILE* script_file = NULL;
+static char* script_path = NULL;   // as given to input_load_script; "-" is stdin
+
+static char pending_buffer[2048];
+
+static int find_request(int pid) {
+    for (int i = 0; i < request_count; i++) {
+        if (requests[i].pid == pid) return i;
+    }
+    return -1;
+}
+
+static void remove_request(int index) {
+    memmove(&requests[index], &requests[index + 1],
+            (request_count - index - 1) * sizeof(InputRequest));
+    request_count--;
+}
+
+// The GUI prompts for the oldest unanswered request
+static void refresh_prompt() {
+    const char* prompt = input_oldest_prompt();
+    snprintf(purpose_msg, sizeof(purpose_msg), "%s", prompt ? prompt : "");
+}
+
+static void close_script() {
+    if (script_file && script_file != stdin) fclose(script_file);
+    script_file = NULL;
+    free(script_path);
+    script_path = NULL;
+}
+
+static bool next_scripted_answer(char* buffer, int size) {
+    if (scripted_head < scripted_count) {
+        snprintf(buffer, size, "%s", scripted[scripted_head]);
+        free(scripted[scripted_head]);
+        scripted_head++;
+        if (scripted_head == scripted_count) scripted_head = scripted_count = 0;
+        return true;
+    }
+    if (script_file) {
+        char line[MAX_INPUT_VALUE];
+        if (fgets(line, sizeof(line), script_file)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            snprintf(buffer, size, "%s", line);
+            return true;
+        }
+        // Exhausted: fall back to interactive answers
+        close_script();
+        printf("[INPUT] Input script exhausted\n");
+    }
+    return false;
+}
+
+// Answer for pcb if one is ready: its own answered request, else the next scripted value
+bool input_take_answer(PCB* pcb, char* buffer, int size) {
+    if (!pcb || !buffer || size <= 0) return false;
+    bool taken = false;
+    scheduler_lock();
+    int index = find_request(pcb->pid);
+    if (index >= 0) {
+        if (requests[index].answered) {
+            snprintf(buffer, size, "%s", requests[index].answer);
+            remove_request(index);
+            taken = true;
+        }
+    } else if (next_scripted_answer(buffer, size)) {
+        char log_msg[512];
+        snprintf(log_msg, sizeof(log_msg), "[INPUT] Scripted input for PID %d: %s", pcb->pid, buffer);
+        log_event(&logger, log_msg);
+        taken = true;
+    }
+    scheduler_unlock();
+    return taken;
+}
+
+// Register pcb's request (once) and block it until input_answer
+void input_request(PCB* pcb, const char* variable) {
+    if (!pcb || !variable) return;
+    scheduler_lock();
+    if (find_request(pcb->pid) < 0) {
+        if (request_count == request_capacity) {
+            int capacity = request_capacity ? request_capacity * 2 : 8;
+            InputRequest* grown = realloc(requests, capacity * sizeof(InputRequest));
+            if (!grown) {
+                printf("[ERROR] Failed to grow input request queue\n");
+                scheduler_unlock();
+                return;
+            }
+            requests = grown;
+            request_capacity = capacity;
+        }
+        InputRequest* request = &requests[request_count++];
+        request->pid = pcb->pid;
+        request->pcb = pcb;
+        snprintf(request->variable, sizeof(request->variable), "%s", variable);
+        snprintf(request->prompt, sizeof(request->prompt),
+                 "Program: %s (PID %d)\nPlease enter a value for [%s]",
+                 pcb->program_name, pcb->pid, variable);
+        request->answered = false;
+        request->answer[0] = '\0';
+        printf("[INPUT] PID %d waiting for input [%s] (%d pending)\n", pcb->pid, variable, request_count);
+    }
+    refresh_prompt();
+    set_pcb_state(pcb, BLOCKED);
+    add_to_blocked_queue(scheduler, pcb);
+    scheduler_unlock();
+}
+
+// Answer pid's pending request and make it runnable again; -1 if it is not waiting
+int input_answer(int pid, const char* value) {
+    if (!value) return -1;
+    scheduler_lock();
+    int index = find_request(pid);
+    if (index < 0 || requests[index].answered) {
+        scheduler_unlock();
+        printf("[WARN] No pending input request for PID %d\n", pid);
+        return -1;
+    }
+    InputRequest* request = &requests[index];
+    snprintf(request->answer, sizeof(request->answer), "%s", value);
+    request->answered = true;
+
+    bool unblocked = false;
+    if (scheduler) {
+        if (remove_from_blocked_queue(scheduler, request->pcb)) {
+            set_pcb_state(request->pcb, READY);
+            add_process(scheduler, request->pcb);
+            unblocked = true;
+        }
+    }
+    if (!unblocked) {
+        // The process went away while waiting; nobody will consume the answer
+        remove_request(index);
+    }
+    refresh_prompt();
+    scheduler_unlock();
+
+    char log_msg[512];
+    snprintf(log_msg, sizeof(log_msg), "[INPUT] Answered PID %d: %s", pid, value);
+    log_event(&logger, log_msg);
+    return 0;
+}
+
+int input_pending_count() {
+    int pending = 0;
+    scheduler_lock();
+    for (int i = 0; i < request_count; i++) {
+        if (!requests[i].answered) pending++;
+    }
+    scheduler_unlock();
+    return pending;
+}
+
+int input_oldest_pending_pid() {
+    int pid = -1;
+    scheduler_lock();
+    for (int i = 0; i < request_count; i++) {
+        if (!requests[i].answered) {
+            pid = requests[i].pid;
+            break;
+        }
+    }
+    scheduler_unlock();
+    return pid;
+}
+
+const char* input_oldest_prompt() {
+    for (int i = 0; i < request_count; i++) {
+        if (!requests[i].answered) return requests[i].prompt;
+    }
+    return NULL;
+}
+
+// "pid,program,variable" per pending request, oldest first
+const char* input_pending_requests() {
+    pending_buffer[0] = '\0';
+    int offset = 0;
+    scheduler_lock();
+    for (int i = 0; i < request_count; i++) {
+        if (requests[i].answered) continue;
+        int written = snprintf(pending_buffer + offset, sizeof(pending_buffer) - offset,
+                               "%d,%s,%s\n", requests[i].pid,
+                               requests[i].pcb->program_name, requests[i].variable);
+        if (written < 0 || written >= (int)sizeof(pending_buffer) - offset) break;
+        offset += written;
+    }
+    scheduler_unlock();
+    return pending_buffer;
+}
+
+// Requests made before a feed was available are answered from it straight away
+static void answer_pending_from_script() {
+    char value[MAX_INPUT_VALUE];
+    int pid;
+    while ((pid = input_oldest_pending_pid()) >= 0 && next_scripted_answer(value, sizeof(value))) {
+        input_answer(pid, value);
+    }
+}
+
+// Read answers from path ("-" for stdin) one line per input, lazily as programs ask
+int input_load_script(const char* path) {
+    if (!path) return -1;
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        printf("[ERROR] Cannot open input script %s\n", path);
+        return -1;
+    }
+    scheduler_lock();
+    close_script();
+    script_file = file;
+    script_path = strdup(path);
+    answer_pending_from_script();
+    scheduler_unlock();
+    printf("[INPUT] Reading scripted input from %s\n", file == stdin ? "stdin" : path);
+    return 0;
+}
+
+void input_add_scripted_answer(const char* value) {
+    if (!value) return;
+    scheduler_lock();
+    if (scripted_count == scripted_capacity) {
+        int capacity = scripted_capacity ? scripted_capacity * 2 : 8;
+        char** grown = realloc(scripted, capacity * sizeof(char*));
+        if (!grown) {
+            printf("[ERROR] Failed to grow scripted input queue\n");
+            scheduler_unlock();
+            return;
+        }
+        scripted = grown;
+        scripted_capacity = capacity;
+    }
+    scripted[scripted_count++] = strdup(value);
+    answer_pending_from_script();
+    scheduler_unlock();
+}
+
+// Checkpoint support: the live request list, oldest first
+const InputRequest* input_requests(int* count) {
+    if (count) *count = request_count;
+    return requests;
+}
+
+// Checkpoint support: explicit answers not yet handed out, and where the script feed
+// stands. *path is NULL without a feed; *offset is -1 for stdin, which cannot seek.
+int input_script_state(char* const** answers, const char** path, long* offset) {
+    *answers = scripted + scripted_head;
+    *path = script_file ? script_path : NULL;
+    *offset = script_file && script_file != stdin ? ftell(script_file) : -1;
+    return scripted_count - scripted_head;
+}
+
+// Replace the scripted feed with a checkpoint's. A script file is reopened and read on
+// from the saved offset; a stdin feed just keeps reading stdin. False if the file is gone.
+bool input_restore_script(char* const* answers, int count, const char* path, long offset) {
+    scheduler_lock();
+    for (int i = scripted_head; i < scripted_count; i++) free(scripted[i]);
+    scripted_head = scripted_count = 0;
+    close_script();
+    scheduler_unlock();
+    for (int i = 0; i < count; i++) input_add_scripted_answer(answers[i]);
+    if (!path) return true;
+
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file || (file != stdin && fseek(file, offset, SEEK_SET) != 0)) {
+        if (file) fclose(file);
+        printf("[WARN] Input script %s from the checkpoint cannot be reopened; scripted input stops here\n", path);
+        return false;
+    }
+    scheduler_lock();
+    script_file = file;
+    script_path = strdup(path);
+    scheduler_unlock();
+    return true;
+}
+
+// Re-queue a request read back from a checkpoint; its PCB is already in the blocked queue
+void input_restore_request(PCB* pcb, const char* variable, const char* prompt, bool answered, const char* answer) {
+    if (!pcb || !variable) return;
+    scheduler_lock();
+    if (request_count == request_capacity) {
+        int capacity = request_capacity ? request_capacity * 2 : 8;
+        InputRequest* grown = realloc(requests, capacity * sizeof(InputRequest));
+        if (!grown) {
+            printf("[ERROR] Failed to grow input request queue\n");
+            scheduler_unlock();
+            return;
+        }
+        requests = grown;
+        request_capacity = capacity;
+    }
+    InputRequest* request = &requests[request_count++];
+    request->pid = pcb->pid;
+    request->pcb = pcb;
+    snprintf(request->variable, sizeof(request->variable), "%s", variable);
+    snprintf(request->prompt, sizeof(request->prompt), "%s", prompt ? prompt : "");
+    request->answered = answered;
+    snprintf(request->answer, sizeof(request->answer), "%s", answer ? answer : "");
+    refresh_prompt();
+    scheduler_unlock();
+}
+
+// Drop pending requests, whose PCBs are gone after a reset; scripted feeds survive like other settings
+void input_reset() {
+    scheduler_lock();
+    request_count = 0;
+    purpose_msg[0] = '\0';
+    scheduler_unlock();
+}
@@ -2,11 +2,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include "globals.h"
 #include "interpreter.h"
+#include "aio.h"
+#include "device.h"
+#include "input.h"
+#include "vfs.h"
 #include "memory.h"
 #include "mutex.h"
 #include "pcb.h"
+#include "program.h"
 #include "queue.h"
 #include "scheduler.h"  
 #include "logger.h"
@@ -18,6 +24,10 @@
 
 char purpose_msg[256] = "";
 
+// Extra cycles each instruction type keeps the CPU busy for; 0 = the usual single cycle
+static int extra_cycles[INSTR_UNKNOWN + 1];
+static bool compute_single_cycle = true;   // fast runs assume every compute instruction takes one cycle
+
 InstructionType parse_instruction(const char* instruction) {
     if (!instruction) return INSTR_UNKNOWN;
     if (strncmp(instruction, "printFromTo", 11) == 0) return INSTR_PRINT_FROM_TO;
@@ -27,14 +37,176 @@ InstructionType parse_instruction(const char* instruction) {
     if (strncmp(instruction, "readFile", 8) == 0) return INSTR_READ_FILE;
     if (strncmp(instruction, "semWait", 7) == 0) return INSTR_SEM_WAIT;
     if (strncmp(instruction, "semSignal", 9) == 0) return INSTR_SEM_SIGNAL;
+    if (strncmp(instruction, "semInit", 7) == 0) return INSTR_SEM_INIT;
+
+    // Short mnemonics must match the whole first word
+    static const struct { const char* name; InstructionType type; } mnemonics[] = {
+        {"add", INSTR_ADD}, {"sub", INSTR_SUB}, {"mul", INSTR_MUL}, {"div", INSTR_DIV},
+        {"eq", INSTR_EQ}, {"ne", INSTR_NE}, {"lt", INSTR_LT}, {"le", INSTR_LE},
+        {"gt", INSTR_GT}, {"ge", INSTR_GE},
+        {"jmp", INSTR_JMP}, {"jz", INSTR_JZ}, {"jnz", INSTR_JNZ},
+        {"sleep", INSTR_SLEEP},
+    };
+    size_t length = strcspn(instruction, " \t");
+    for (size_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); i++) {
+        if (strlen(mnemonics[i].name) == length && strncmp(instruction, mnemonics[i].name, length) == 0) {
+            return mnemonics[i].type;
+        }
+    }
     return INSTR_UNKNOWN;
 }
 
+// Whether the instruction stores into the variable named by its first operand
+bool instruction_writes_variable(InstructionType type) {
+    return type == INSTR_ASSIGN || (type >= INSTR_ADD && type <= INSTR_GE);
+}
+
+// Token index of the branch target, -1 for instructions that do not branch
+int branch_target_token(InstructionType type) {
+    switch (type) {
+        case INSTR_JMP: return 1;
+        case INSTR_JZ:
+        case INSTR_JNZ: return 2;
+        default: return -1;
+    }
+}
+
+// Cycles an instruction of this type occupies the CPU
+int instruction_cost(InstructionType type) {
+    if (type < 0 || type > INSTR_UNKNOWN) return 1;
+    return 1 + extra_cycles[type];
+}
+
+void set_instruction_cost(InstructionType type, int cycles) {
+    if (type < 0 || type > INSTR_UNKNOWN) return;
+    extra_cycles[type] = cycles > 1 ? cycles - 1 : 0;
+    compute_single_cycle = extra_cycles[INSTR_ASSIGN] == 0;
+    for (int t = INSTR_ADD; t <= INSTR_JNZ; t++) {
+        if (extra_cycles[t] != 0) compute_single_cycle = false;
+    }
+}
+
+// Variable value or integer literal; false if it is neither
+static bool operand_value(PCB* pcb, const char* token, long long* value) {
+    const char* text = get_pcb_variable(pcb, token);
+    if (!text) text = token;
+    char* end;
+    *value = strtoll(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+// add/sub/mul/div and the comparisons: tokens[1] = tokens[2] op tokens[3]
+static void execute_arithmetic(PCB* pcb, InstructionType type, char** tokens, Logger* logger) {
+    long long a, b, result = 0;
+    char log_msg[256];
+    if (!operand_value(pcb, tokens[2], &a) || !operand_value(pcb, tokens[3], &b)) {
+        snprintf(log_msg, sizeof(log_msg), "[ERROR] [PID %d] Non-numeric operand in %s, [%s] set to 0",
+            pcb->pid, tokens[0], tokens[1]);
+        log_event(logger, log_msg);
+    } else {
+        bool overflow = false;
+        switch (type) {
+            case INSTR_ADD: overflow = __builtin_add_overflow(a, b, &result); break;
+            case INSTR_SUB: overflow = __builtin_sub_overflow(a, b, &result); break;
+            case INSTR_MUL: overflow = __builtin_mul_overflow(a, b, &result); break;
+            case INSTR_DIV:
+                if (b == 0) {
+                    snprintf(log_msg, sizeof(log_msg), "[ERROR] [PID %d] Division by zero, [%s] set to 0",
+                        pcb->pid, tokens[1]);
+                    log_event(logger, log_msg);
+                } else if (a == LLONG_MIN && b == -1) {
+                    overflow = true;
+                } else {
+                    result = a / b;
+                }
+                break;
+            case INSTR_EQ: result = a == b; break;
+            case INSTR_NE: result = a != b; break;
+            case INSTR_LT: result = a < b; break;
+            case INSTR_LE: result = a <= b; break;
+            case INSTR_GT: result = a > b; break;
+            case INSTR_GE: result = a >= b; break;
+            default: break;
+        }
+        if (overflow) {
+            result = 0;
+            snprintf(log_msg, sizeof(log_msg), "[ERROR] [PID %d] Overflow in %s, [%s] set to 0",
+                pcb->pid, tokens[0], tokens[1]);
+            log_event(logger, log_msg);
+        }
+    }
+    char value[32];
+    snprintf(value, sizeof(value), "%lld", result);
+    update_pcb_variable(pcb, tokens[1], value);
+}
+
+// Undeclared names become binary semaphores on first use
 ResourceType parse_resource(const char* token) {
-    if (strcmp(token, "userInput") == 0) return RESOURCE_USER_INPUT;
-    if (strcmp(token, "userOutput") == 0) return RESOURCE_USER_OUTPUT;
-    if (strcmp(token, "file") == 0) return RESOURCE_FILE;
-    return NUM_RESOURCES;
+    if (!token) return RESOURCE_INVALID;
+    ResourceType res = find_resource(&resource_manager, token);
+    if (res == RESOURCE_INVALID) res = register_resource(&resource_manager, token, 1);
+    return res;
+}
+
+// Handle a "semInit <name> [count]" declaration line
+static void declare_semaphore(const char* line) {
+    char keyword[16], name[MAX_RESOURCE_NAME];
+    int count = 1;
+    if (sscanf(line, "%15s %63s %d", keyword, name, &count) < 2) {
+        printf("[WARN] Malformed semaphore declaration ignored: %s\n", line);
+        return;
+    }
+    int id = register_resource(&resource_manager, name, count);
+    printf("[DEBUG] semInit: resource [%s] -> id %d (%d unit(s))\n", name, id, count);
+}
+
+// Resolve the semaphore operand of every semWait/semSignal once, at load time.
+// Ids depend on the resource manager, so they are per process even when the text is shared.
+static void resolve_resources(PCB* pcb, const Program* program) {
+    free(pcb->resource_ids);
+    pcb->resource_ids = malloc((pcb->instruction_count ? pcb->instruction_count : 1) * sizeof(int));
+    if (!pcb->resource_ids) return;
+    for (int i = 0; i < pcb->instruction_count; i++) {
+        const char* name = program->resource_names[i];
+        pcb->resource_ids[i] = name ? parse_resource(name) : RESOURCE_INVALID;
+    }
+}
+
+// readFile through the vfs, or through the I/O threads when async I/O is on.
+// Returns false when the process blocked; the instruction runs again once the read completes.
+// *device is set when the read went straight to the vfs and still owes the disk its time.
+static bool file_read(PCB* pcb, const char* filename, char** content, DeviceId* device) {
+    AioRequest* completed = aio_take_completion(pcb);
+    if (completed) {
+        *content = completed->data;
+        completed->data = NULL;
+        aio_free_request(completed);
+        return true;
+    }
+    if (!aio_is_enabled()) {
+        *content = vfs_read(filename);
+        *device = DEVICE_DISK;
+        return true;
+    }
+    aio_submit(pcb, AIO_READ, filename, NULL);
+    return false;
+}
+
+// writeFile counterpart of file_read; *written reports whether the write succeeded
+static bool file_write(PCB* pcb, const char* filename, const char* data, bool* written, DeviceId* device) {
+    AioRequest* completed = aio_take_completion(pcb);
+    if (completed) {
+        *written = completed->ok;
+        aio_free_request(completed);
+        return true;
+    }
+    if (!aio_is_enabled()) {
+        *written = vfs_write(filename, data);
+        *device = DEVICE_DISK;
+        return true;
+    }
+    aio_submit(pcb, AIO_WRITE, filename, data);
+    return false;
 }
 
 PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resources, Logger* logger, bool* success) {
@@ -66,9 +238,12 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
     }
 
     InstructionType type = parse_instruction(tokens[0]);
-    printf("[DEBUG] Instruction Type: %d | Instruction: %s\n", type, instruction);
+    if (scheduler && scheduler->verbose) printf("[DEBUG] Instruction Type: %d | Instruction: %s\n", type, instruction);
     *success = true;
     PCB* unblocked = NULL;
+    int next_pc = -1;   // set by a taken branch
+    DeviceId device = DEVICE_COUNT;   // device the instruction still has to wait for, if any
+    int sleep_cycles = 0;
 
     switch (type) {
         case INSTR_PRINT: {
@@ -79,6 +254,7 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
                             pcb->program_name, pcb->pid, val ? val : tokens[1]);
                 log_event(logger, log_msg);
                 printf("Printing: %s\n", val ? val : tokens[1]);
+                device = DEVICE_CONSOLE;
             } else {
                 *success = false;
             }
@@ -87,9 +263,9 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
         case INSTR_ASSIGN: {
             if (token_count >= 3) {
                 if (strcmp(tokens[2], "input") == 0) {
-                    if (gui_input_ready == 1) {
-                        gui_input_ready = 0;
-                        update_pcb_variable(pcb, tokens[1], gui_input_buffer);
+                    char input_value[MAX_INPUT_VALUE];
+                    if (input_take_answer(pcb, input_value, sizeof(input_value))) {
+                        update_pcb_variable(pcb, tokens[1], input_value);
                         // Sync the updated variable into memory after GUI input is received
                         int var_index = -1;
                         for (int i = 0; i < pcb->var_count; i++) {
@@ -101,55 +277,30 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
                         if (var_index == -1) {
                             var_index = pcb->var_count;
                         }
-                        int addr = pcb->memory_lower_bound + pcb->instruction_count + var_index;
-                        write_memory(memory, addr, tokens[1], gui_input_buffer, pcb->pid);
+                        int addr = pcb_variable_address(pcb, var_index);
+                        if (addr >= 0) write_memory(memory, addr, tokens[1], input_value, pcb->pid);
                         snprintf(log_msg, sizeof(log_msg),
-                                 "[GUI_INPUT]  Assigned [%s] = [%s]", tokens[1], gui_input_buffer);
+                                 "[GUI_INPUT]  Assigned [%s] = [%s]", tokens[1], input_value);
                         log_event(logger, log_msg);
-        
-                        //int addr = pcb->memory_lower_bound + pcb->program_counter;
-                        //write_memory(memory, addr, tokens[1], gui_input_buffer, pcb->pid);
                     } else {
-                        gui_input_ready = -1;
-                        snprintf(purpose_msg, sizeof(purpose_msg),
-                                    "Program: %s (PID %d)\nPlease enter a value for [%s]",
-                                    pcb->program_name, pcb->pid, tokens[1]);
-        
-                        int var_index = -1;
-                        for (int i = 0; i < pcb->var_count; i++) {
-                            if (strcmp(pcb->variables[i], tokens[1]) == 0) {
-                                var_index = i;
-                                break;
-                            }
-                        }
-                        if (var_index == -1) {
-                            var_index = pcb->var_count;  
-                        }
-                        int addr = pcb->memory_lower_bound + pcb->instruction_count + var_index;
-                        set_pcb_state(pcb, BLOCKED);
-                        add_to_queue(&scheduler->blocked_queue, pcb);
-
+                        // Each process gets its own request; answer_input(pid, ...) unblocks it
+                        input_request(pcb, tokens[1]);
                         printf("[DEBUG] Waiting for GUI input - setting success = false\n");
                         *success = false;
                     }
                 } else if (strcmp(tokens[2], "readFile") == 0 && token_count == 4) {
                     const char* filename = get_pcb_variable(pcb, tokens[3]);
-                    if (filename) {
-                        FILE* file = fopen(filename, "r");
-                        if (file) {
-                            char content[256];
-                            if (fgets(content, sizeof(content), file)) {
-                                content[strcspn(content, "\n")] = 0;
-                                update_pcb_variable(pcb, tokens[1], content);
-                                snprintf(log_msg, sizeof(log_msg),
-                                            "[Program: %s | PID %d] [GUI_FILE_READ] READ [%s] into [%s]: %s",
-                                            pcb->program_name, pcb->pid, filename, tokens[1], content);
-                                log_event(logger, log_msg);
-        
-                                //int addr = pcb->memory_lower_bound + pcb->program_counter;
-                                //write_memory(memory, addr, tokens[1], content, pcb->pid);
-                            }
-                            fclose(file);
+                    char* content = NULL;
+                    if (filename && !file_read(pcb, filename, &content, &device)) {
+                        *success = false;
+                    } else if (filename) {
+                        if (content) {
+                            update_pcb_variable(pcb, tokens[1], content);
+                            snprintf(log_msg, sizeof(log_msg),
+                                        "[Program: %s | PID %d] [GUI_FILE_READ] READ [%s] into [%s]: %s",
+                                        pcb->program_name, pcb->pid, filename, tokens[1], content);
+                            log_event(logger, log_msg);
+                            free(content);
                         }
                     }
                 } else {
@@ -166,8 +317,8 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
             if (var_index == -1) {
                 var_index = pcb->var_count;
             }
-            int addr = pcb->memory_lower_bound + pcb->instruction_count + var_index;
-            write_memory(memory, addr, tokens[1], val ? val : tokens[2], pcb->pid);
+            int addr = pcb_variable_address(pcb, var_index);
+            if (addr >= 0) write_memory(memory, addr, tokens[1], val ? val : tokens[2], pcb->pid);
             snprintf(log_msg, sizeof(log_msg),
                     " Assigned [%s] = [%s]", tokens[1], val ? val : tokens[2]);
             log_event(logger, log_msg);
@@ -205,6 +356,7 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
 
                 // Also print to console for debug
                 printf("%s\n", range_output + strlen("[GUI_PRINT_FROM_TO] "));
+                device = DEVICE_CONSOLE;
             }
             break;
         case INSTR_WRITE_FILE: {
@@ -213,10 +365,10 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
                 const char* data = get_pcb_variable(pcb, tokens[2]);
                 if (!filename) filename = tokens[1];
                 if (!data) data = tokens[2];
-                FILE* file = fopen(filename, "w");
-                if (file) {
-                    fprintf(file, "%s\n", data);
-                    fclose(file);
+                bool written = false;
+                if (!file_write(pcb, filename, data, &written, &device)) {
+                    *success = false;
+                } else if (written) {
                     snprintf(log_msg, sizeof(log_msg),
                             "[Program: %s | PID %d] [GUI_FILE_WRITE]  Wrote to [%s]: %s", pcb->program_name, pcb->pid, filename, data);   
                     log_event(logger, log_msg);
@@ -229,14 +381,21 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
         case INSTR_SEM_WAIT:
         case INSTR_SEM_SIGNAL: {
             if (token_count >= 2) {
-                ResourceType res = parse_resource(tokens[1]);
-                if (res != NUM_RESOURCES) {
+                ResourceType res = pcb->resource_ids ? pcb->resource_ids[pcb->program_counter]
+                                                     : parse_resource(tokens[1]);
+                if (res != RESOURCE_INVALID) {
                     if (type == INSTR_SEM_WAIT) {
-                        if (!sem_wait(resources, res, pcb, logger)) {
+                        if (!sem_acquire(resources, res, pcb, logger)) {
+                            // A blocked semWait is always a fresh wait, so (re)start its timeout
+                            long long timeout;
+                            if (token_count >= 3 && pcb->state == BLOCKED && operand_value(pcb, tokens[2], &timeout) && timeout >= 0) {
+                                arm_process_timer(pcb, TIMER_SEM_TIMEOUT, scheduler->clock_cycle + (int)timeout);
+                            }
                             *success = false;
                             free(instruction_copy);
                             return NULL;
                         }
+                        if (pcb->timer.kind == TIMER_SEM_TIMEOUT) cancel_process_timer(pcb);
                     } else {
                         unblocked = sem_signal(resources, res, pcb, logger);
                     }
@@ -246,6 +405,48 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
             }
             break;
         }
+        case INSTR_SEM_INIT:
+            // Declarations are consumed by load_program; nothing to do at run time
+            break;
+        case INSTR_ADD: case INSTR_SUB: case INSTR_MUL: case INSTR_DIV:
+        case INSTR_EQ: case INSTR_NE: case INSTR_LT: case INSTR_LE: case INSTR_GT: case INSTR_GE:
+            if (token_count == 4) {
+                execute_arithmetic(pcb, type, tokens, logger);
+            } else {
+                *success = false;
+            }
+            break;
+        case INSTR_JMP:
+        case INSTR_JZ:
+        case INSTR_JNZ: {
+            // Labels were turned into instruction indices when the program was loaded
+            int target_token = branch_target_token(type);
+            if (token_count != target_token + 1) {
+                *success = false;
+                break;
+            }
+            bool taken = true;
+            if (type != INSTR_JMP) {
+                long long value = 0;
+                operand_value(pcb, tokens[1], &value);
+                taken = type == INSTR_JZ ? value == 0 : value != 0;
+            }
+            if (taken) next_pc = atoi(tokens[target_token]);
+            break;
+        }
+        case INSTR_SLEEP: {
+            long long cycles = 0;
+            if (token_count != 2) {
+                *success = false;
+            } else if (!operand_value(pcb, tokens[1], &cycles) || cycles < 0 || cycles > TIMER_MAX_DELAY) {
+                snprintf(log_msg, sizeof(log_msg), "[ERROR] [PID %d] Bad sleep time [%s], not sleeping",
+                    pcb->pid, tokens[1]);
+                log_event(logger, log_msg);
+                cycles = 0;
+            }
+            sleep_cycles = (int)cycles;
+            break;
+        }
         default:
             snprintf(log_msg, sizeof(log_msg), " Unknown instruction: %s", tokens[0]);
             log_event(logger, log_msg);
@@ -254,8 +455,14 @@ PCB* execute_instruction_core(PCB* pcb, Memory* memory, ResourceManager* resourc
     }
 
     free(instruction_copy);
-    if (*success) pcb->program_counter++;
-    printf("[DEBUG]  Memory synced for PID %d after execution step.\n", pcb->pid);
+    if (*success) {
+        pcb->program_counter = next_pc >= 0 ? next_pc : pcb->program_counter + 1;
+        pcb->stall_cycles = extra_cycles[type];
+        // The instruction has done its work; the process now waits for the device to finish it
+        if (device != DEVICE_COUNT) device_block(pcb, device);
+        else if (sleep_cycles > 0) sleep_process(scheduler, pcb, sleep_cycles);
+    }
+    if (scheduler && scheduler->verbose) printf("[DEBUG]  Memory synced for PID %d after execution step.\n", pcb->pid);
     return unblocked;
 }
 
@@ -263,98 +470,325 @@ PCB* execute_instruction(PCB* pcb, Memory* memory, ResourceManager* resources, L
     return execute_instruction_core(pcb, memory, resources, logger, success);
 }
 
+// ---- Fast runs over the decoded table ----
+// A run keeps the program's variables in integer registers and only goes back to the
+// string variables (and memory) once at the end. It stops in front of the first
+// instruction it cannot do on its own, leaving it for execute_instruction_core.
+// The dispatch is a handler table, or computed goto when built with INTERP_COMPUTED_GOTO.
+
+typedef struct {
+    long long* values;
+    unsigned char* valid;      // holds an integer that prints back as the stored string
+    unsigned char* dirty;      // written during the run
+} Registers;
+
+#define RUN_STACK_REGISTERS 64
+
+static inline bool fetch(const Registers* regs, const Operand* operand, long long* value) {
+    if (operand->slot < 0) {
+        *value = operand->literal;
+        return true;
+    }
+    *value = regs->values[operand->slot];
+    return regs->valid[operand->slot];
+}
+
+static inline void store(Registers* regs, int slot, long long value) {
+    regs->values[slot] = value;
+    regs->valid[slot] = 1;
+    regs->dirty[slot] = 1;
+}
+
+static void load_registers(PCB* pcb, const Program* program, Registers* regs) {
+    for (int v = 0; v < program->variable_count; v++) {
+        const char* text = get_pcb_variable(pcb, program->variable_names[v]);
+        regs->valid[v] = 0;
+        regs->dirty[v] = 0;
+        if (!text) continue;
+        char* end;
+        regs->values[v] = strtoll(text, &end, 10);
+        char canonical[32];
+        snprintf(canonical, sizeof(canonical), "%lld", regs->values[v]);
+        regs->valid[v] = end != text && *end == '\0' && strcmp(canonical, text) == 0;
+    }
+}
+
+static void store_registers(PCB* pcb, const Program* program, const Registers* regs) {
+    for (int v = 0; v < program->variable_count; v++) {
+        if (!regs->dirty[v]) continue;
+        char value[32];
+        snprintf(value, sizeof(value), "%lld", regs->values[v]);
+        update_pcb_variable(pcb, program->variable_names[v], value);
+    }
+}
+
+#ifndef INTERP_COMPUTED_GOTO
+// Each handler returns the next program counter, or -1 to stop in front of the instruction
+typedef int (*OpHandler)(Registers* regs, const DecodedInstruction* in, int pc);
+
+static int op_slow(Registers* regs, const DecodedInstruction* in, int pc) {
+    (void)regs; (void)in; (void)pc;
+    return -1;
+}
+
+static int op_assign(Registers* regs, const DecodedInstruction* in, int pc) {
+    long long a;
+    if (!fetch(regs, &in->a, &a)) return -1;
+    store(regs, in->dest, a);
+    return pc + 1;
+}
+
+#define BINARY_HANDLER(name, expr) \
+    static int name(Registers* regs, const DecodedInstruction* in, int pc) { \
+        long long a, b; \
+        if (!fetch(regs, &in->a, &a) || !fetch(regs, &in->b, &b)) return -1; \
+        store(regs, in->dest, (expr)); \
+        return pc + 1; \
+    }
+
+// Overflow, like division by zero, is left to the slow path, which reports it
+#define CHECKED_HANDLER(name, checked_op) \
+    static int name(Registers* regs, const DecodedInstruction* in, int pc) { \
+        long long a, b, result; \
+        if (!fetch(regs, &in->a, &a) || !fetch(regs, &in->b, &b) || checked_op(a, b, &result)) return -1; \
+        store(regs, in->dest, result); \
+        return pc + 1; \
+    }
+
+CHECKED_HANDLER(op_add, __builtin_add_overflow)
+CHECKED_HANDLER(op_sub, __builtin_sub_overflow)
+CHECKED_HANDLER(op_mul, __builtin_mul_overflow)
+BINARY_HANDLER(op_eq, a == b)
+BINARY_HANDLER(op_ne, a != b)
+BINARY_HANDLER(op_lt, a < b)
+BINARY_HANDLER(op_le, a <= b)
+BINARY_HANDLER(op_gt, a > b)
+BINARY_HANDLER(op_ge, a >= b)
+
+// Division by zero and LLONG_MIN / -1 are left to the slow path, which reports them
+static int op_div(Registers* regs, const DecodedInstruction* in, int pc) {
+    long long a, b;
+    if (!fetch(regs, &in->a, &a) || !fetch(regs, &in->b, &b) || b == 0 || (a == LLONG_MIN && b == -1)) return -1;
+    store(regs, in->dest, a / b);
+    return pc + 1;
+}
+
+static int op_jmp(Registers* regs, const DecodedInstruction* in, int pc) {
+    (void)regs; (void)pc;
+    return in->target;
+}
+
+static int op_jz(Registers* regs, const DecodedInstruction* in, int pc) {
+    long long a;
+    if (!fetch(regs, &in->a, &a)) return -1;
+    return a == 0 ? in->target : pc + 1;
+}
+
+static int op_jnz(Registers* regs, const DecodedInstruction* in, int pc) {
+    long long a;
+    if (!fetch(regs, &in->a, &a)) return -1;
+    return a != 0 ? in->target : pc + 1;
+}
+
+static const OpHandler handlers[OP_COUNT] = {
+    [OP_SLOW] = op_slow, [OP_ASSIGN] = op_assign,
+    [OP_ADD] = op_add, [OP_SUB] = op_sub, [OP_MUL] = op_mul, [OP_DIV] = op_div,
+    [OP_EQ] = op_eq, [OP_NE] = op_ne, [OP_LT] = op_lt, [OP_LE] = op_le, [OP_GT] = op_gt, [OP_GE] = op_ge,
+    [OP_JMP] = op_jmp, [OP_JZ] = op_jz, [OP_JNZ] = op_jnz,
+};
+
+static int dispatch_run(Registers* regs, const DecodedInstruction* code, int count, int* pc, int budget) {
+    int executed = 0;
+    int at = *pc;
+    while (executed < budget && at < count) {
+        int next = handlers[code[at].opcode](regs, &code[at], at);
+        if (next < 0) break;
+        at = next;
+        executed++;
+    }
+    *pc = at;
+    return executed;
+}
+#else
+static int dispatch_run(Registers* regs, const DecodedInstruction* code, int count, int* pc, int budget) {
+    static void* const labels[OP_COUNT] = {
+        [OP_SLOW] = &&done, [OP_ASSIGN] = &&do_assign,
+        [OP_ADD] = &&do_add, [OP_SUB] = &&do_sub, [OP_MUL] = &&do_mul, [OP_DIV] = &&do_div,
+        [OP_EQ] = &&do_eq, [OP_NE] = &&do_ne, [OP_LT] = &&do_lt, [OP_LE] = &&do_le, [OP_GT] = &&do_gt, [OP_GE] = &&do_ge,
+        [OP_JMP] = &&do_jmp, [OP_JZ] = &&do_jz, [OP_JNZ] = &&do_jnz,
+    };
+    int executed = 0;
+    int at = *pc;
+    const DecodedInstruction* in;
+    long long a, b, result;
+
+#define DISPATCH() do { \
+        if (executed == budget || at >= count) goto done; \
+        in = &code[at]; \
+        goto *labels[in->opcode]; \
+    } while (0)
+#define NEXT(target) do { at = (target); executed++; DISPATCH(); } while (0)
+#define FETCH(operand, value) do { if (!fetch(regs, &in->operand, &value)) goto done; } while (0)
+#define BINARY(label, expr) \
+    label: FETCH(a, a); FETCH(b, b); store(regs, in->dest, (expr)); NEXT(at + 1);
+// Overflow goes to the slow path, which reports it
+#define CHECKED(label, checked_op) \
+    label: FETCH(a, a); FETCH(b, b); if (checked_op(a, b, &result)) goto done; \
+    store(regs, in->dest, result); NEXT(at + 1);
+
+    DISPATCH();
+do_assign:
+    FETCH(a, a);
+    store(regs, in->dest, a);
+    NEXT(at + 1);
+    CHECKED(do_add, __builtin_add_overflow)
+    CHECKED(do_sub, __builtin_sub_overflow)
+    CHECKED(do_mul, __builtin_mul_overflow)
+    BINARY(do_eq, a == b)
+    BINARY(do_ne, a != b)
+    BINARY(do_lt, a < b)
+    BINARY(do_le, a <= b)
+    BINARY(do_gt, a > b)
+    BINARY(do_ge, a >= b)
+do_div:
+    FETCH(a, a);
+    FETCH(b, b);
+    if (b == 0 || (a == LLONG_MIN && b == -1)) goto done;   // reported by the slow path
+    store(regs, in->dest, a / b);
+    NEXT(at + 1);
+do_jmp:
+    NEXT(in->target);
+do_jz:
+    FETCH(a, a);
+    NEXT(a == 0 ? in->target : at + 1);
+do_jnz:
+    FETCH(a, a);
+    NEXT(a != 0 ? in->target : at + 1);
+done:
+#undef CHECKED
+#undef BINARY
+#undef FETCH
+#undef NEXT
+#undef DISPATCH
+    *pc = at;
+    return executed;
+}
+#endif
+
+const char* interpreter_dispatch_mode() {
+#ifdef INTERP_COMPUTED_GOTO
+    return "computed-goto";
+#else
+    return "handler-table";
+#endif
+}
+
+// Run up to budget instructions of pcb straight off its decoded program, without the
+// per-instruction logging and scheduler bookkeeping. Returns how many ran; it stops early
+// at the end of the program or in front of anything that needs execute_instruction_core.
+// Runs are off while any compute instruction is configured to take more than one cycle.
+int execute_instruction_run(PCB* pcb, int budget) {
+    if (!pcb || budget <= 0 || !compute_single_cycle || !pcb->program || !pcb->program->decoded) return 0;
+    const Program* program = pcb->program;
+    int start = pcb->program_counter;
+    if (start < 0 || start >= program->instruction_count || program->decoded[start].opcode == OP_SLOW) return 0;
+
+    long long stack_values[RUN_STACK_REGISTERS];
+    unsigned char stack_flags[2 * RUN_STACK_REGISTERS];
+    Registers regs = {stack_values, stack_flags, stack_flags + RUN_STACK_REGISTERS};
+    long long* heap_values = NULL;
+    unsigned char* heap_flags = NULL;
+    if (program->variable_count > RUN_STACK_REGISTERS) {
+        heap_values = malloc(program->variable_count * sizeof(long long));
+        heap_flags = malloc(2 * program->variable_count);
+        if (!heap_values || !heap_flags) {
+            free(heap_values);
+            free(heap_flags);
+            return 0;
+        }
+        regs.values = heap_values;
+        regs.valid = heap_flags;
+        regs.dirty = heap_flags + program->variable_count;
+    }
+
+    load_registers(pcb, program, &regs);
+    int pc = start;
+    int executed = dispatch_run(&regs, program->decoded, program->instruction_count, &pc, budget);
+    store_registers(pcb, program, &regs);
+    pcb->program_counter = pc;
+    free(heap_values);
+    free(heap_flags);
+
+    if (executed > 0) {
+        char log_msg[256];
+        snprintf(log_msg, sizeof(log_msg), "[Program %d | PID %d] Ran %d instruction(s), PC %d -> %d",
+            pcb->pid, pcb->pid, executed, start, pc);
+        log_event(&logger, log_msg);
+    }
+    return executed;
+}
+
 bool load_program(Memory* memory, PCB* pcb, const char* filename) {
     if (!pcb || !filename || !memory) return false;
 
-    printf("[DEBUG] Opening program file: %s\n", filename);
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+    // Parsed once per file version; every process running it shares the instruction table
+    Program* program = program_load(filename);
+    if (!program) {
         printf(" Failed to open program file: %s\n", filename);
         return false;
     }
-
-    int instruction_count = 0;
-    char line[256];
-    while (fgets(line, sizeof(line), file)) {
-        if (strlen(line) > 1) instruction_count++;
+    printf("[DEBUG] Program %s: %d instruction(s), %d variable(s)\n",
+        filename, program->instruction_count, program->variable_count);
+
+    // The text is mapped once per program; only the PCB words and variables are per process
+    int text_base = -1;
+    if (program->instruction_count > 0) {
+        text_base = attach_text_segment(memory, program, program->instructions, program->instruction_count);
+        if (text_base < 0) {
+            printf(" Failed to map program text for process %d\n", pcb->pid);
+            program_release(program);
+            return false;
+        }
     }
-    rewind(file);
-
-    printf("[DEBUG] Instruction count: %d\n", instruction_count);
-
-    printf("[DEBUG] Attempting memory allocation for PID %d...\n", pcb->pid);
-    int mem_start = allocate_memory(memory, pcb, instruction_count);
+    int mem_start = allocate_memory(memory, pcb, PCB_MEMORY_WORDS + program->variable_count);
     if (mem_start == -1) {
         printf(" Failed to allocate memory for process %d\n", pcb->pid);
-        fclose(file);
+        if (text_base >= 0) detach_text_segment(memory, text_base);
+        program_release(program);
         return false;
     }
 
-    printf("[DEBUG] Memory allocated at [%d - %d] for PID %d\n",
-        pcb->memory_lower_bound, pcb->memory_upper_bound, pcb->pid);
+    printf("[DEBUG] Memory allocated at [%d - %d] for PID %d (text at %d)\n",
+        pcb->memory_lower_bound, pcb->memory_upper_bound, pcb->pid, text_base);
 
-    int index = 0;
-    while (fgets(line, sizeof(line), file)) {
-        line[strcspn(line, "\n")] = 0;
-        if (strlen(line) == 0) continue;
-
-        add_pcb_instruction(pcb, line);
-        printf("[Program %d] Loaded instruction: [%s]\n", pcb->pid, line);
-
-        printf("[DEBUG] Writing to memory address %d (PID %d): %s\n",
-            mem_start + index, pcb->pid, line);
-        write_memory(memory, mem_start + index, "instruction", line, pcb->pid);
-        index++;
+    for (int i = 0; i < program->declaration_count; i++) {
+        declare_semaphore(program->declarations[i]);
     }
+    pcb->program = program;
+    pcb->instructions = program->instructions;
+    pcb->instruction_count = program->instruction_count;
+    pcb->text_base = text_base;
+    update_pcb_state_in_memory(pcb);
 
-    fclose(file);
+    resolve_resources(pcb, program);
     printf("[DEBUG] Program %d fully loaded with %d instructions.\n", pcb->pid, pcb->instruction_count);
     return true;
 }
 
+// Answers the oldest pending input request
 void set_gui_input(const char* input) {
-    if (input) {
-        strncpy(gui_input_buffer, input, sizeof(gui_input_buffer) - 1);
-        gui_input_buffer[sizeof(gui_input_buffer) - 1] = '\0';
-        gui_input_ready = 1;
-        printf("[DEBUG] Received GUI input: %s\n", gui_input_buffer);
-        log_event(&logger, "[GUI] Received input from GUI.");
-
-        if (!scheduler) {
-            printf("[ERROR] Scheduler is NULL in set_gui_input!\n");
-            return;
-        }
-
-        // فك البلوك
-        for (int i = 0; i < scheduler->blocked_queue.size; ) {
-            PCB* blocked_pcb = scheduler->blocked_queue.processes[i];
-            if (blocked_pcb->state == BLOCKED) {
-                int instr_index = blocked_pcb->program_counter;
-                const char* last_instruction = blocked_pcb->instructions[instr_index];
-
-                if (last_instruction) {
-                    char instr_copy[256];
-                    strncpy(instr_copy, last_instruction, sizeof(instr_copy) - 1);
-                    instr_copy[sizeof(instr_copy) - 1] = '\0';
-                    char* first_token = strtok(instr_copy, " ");
-                    char* third_token = NULL;
-                    strtok(NULL, " ");  // skip second token
-                    third_token = strtok(NULL, " ");
-
-                    if (first_token && strcmp(first_token, "assign") == 0 && third_token && strcmp(third_token, "input") == 0) {
-                        printf("[DEBUG] Unblocking PID %d waiting for GUI input (confirmed assign ... input)\n", blocked_pcb->pid);
-                        set_pcb_state(blocked_pcb, READY);
-                        add_process(scheduler, blocked_pcb);
-                        remove_from_queue(&scheduler->blocked_queue, i);
-                        continue;  
-                    }
-                }
-                i++;
-            } 
-        }
+    if (!input) return;
+    printf("[DEBUG] Received GUI input: %s\n", input);
+    log_event(&logger, "[GUI] Received input from GUI.");
+
+    int pid = input_oldest_pending_pid();
+    if (pid < 0) {
+        printf("[WARN] GUI input received but no process is waiting for it\n");
+        return;
     }
+    input_answer(pid, input);
 }
 
 int is_waiting_for_gui_input() {
-    return gui_input_ready == -1;
+    return input_pending_count() > 0;
 }
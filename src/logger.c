@@ -8,6 +8,11 @@
 #include "pcb.h"
 #include "queue.h"
 #include "scheduler.h"
+#include "events.h"
+#include <pthread.h>
+
+// Log lines may come from several CPU threads at once
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 void init_logger(Logger* logger) {
@@ -20,6 +25,7 @@ void init_logger(Logger* logger) {
 }
 
 void log_execution(Logger* logger, int pid, const char* instruction) {
+    pthread_mutex_lock(&log_lock);
     if (logger->execution_count < MAX_LOG_LINES) {
         snprintf(logger->execution_log[logger->execution_count++],
                 MAX_LOG_LENGTH, "[PID %d] Executing: %s", pid, instruction);
@@ -28,11 +34,13 @@ void log_execution(Logger* logger, int pid, const char* instruction) {
         fprintf(logger->log_file, "[PID %d] Executing: %s\n", pid, instruction);
         fflush(logger->log_file);
     }
+    pthread_mutex_unlock(&log_lock);
 }
 
 void log_event(Logger* logger, const char* msg) {
     if (!msg) return;
 
+    pthread_mutex_lock(&log_lock);
     if (logger->log_file) {
         fprintf(logger->log_file, "%s\n", msg);
         fflush(logger->log_file);
@@ -40,6 +48,8 @@ void log_event(Logger* logger, const char* msg) {
 
 
     set_last_log(msg);  
+    pthread_mutex_unlock(&log_lock);
+    event_emit_text(EVENT_LOG, msg);
 }
 
 void print_logs(Logger* logger) {
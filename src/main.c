@@ -0,0 +1,317 @@
+// Headless simulator: bin/run loads a manifest, runs it to completion (or a cycle
+// limit) and prints the metrics report. The simulator's own chatter goes to
+// /dev/null unless --verbose is given, so stdout carries only the report and,
+// when asked for, the trace.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include "scheduler_api.h"
+#include "globals.h"
+#include "input.h"
+
+#define DEFAULT_MAX_CYCLES 1000000
+
+// Exit codes
+#define RUN_COMPLETED 0
+#define RUN_ERROR 1
+#define RUN_INCOMPLETE 2      // hit --max-cycles, or every process is blocked for good
+
+typedef struct {
+    SchedulingAlgorithm algorithm;
+    int quantum;
+    int cpus;
+    int parallel;
+    int work_stealing;
+    int event_driven;
+    int instructions_per_cycle;
+    const char* manifest;
+    const char* input;
+    int max_cycles;
+    int json;
+    const char* trace;
+    int verbose;
+} RunOptions;
+
+static void usage(FILE* out) {
+    fprintf(out,
+        "Usage: run --manifest FILE [options]\n"
+        "  --algo fcfs|rr|mlfq|cfs   scheduling algorithm (default fcfs)\n"
+        "  --quantum N               RR/MLFQ quantum (default 2)\n"
+        "  --cpus N                  simulated CPUs (default 1)\n"
+        "  --parallel                run each CPU's cycle on its own thread\n"
+        "  --no-steal                keep idle CPUs from stealing queued work\n"
+        "  --event-driven            skip idle stretches to the next arrival, wakeup or I/O completion\n"
+        "  --ipc N                   compute-only instructions a CPU may run per cycle (default 1)\n"
+        "  --manifest FILE           processes to load, one '<program> <arrival> [...]' per line\n"
+        "  --input FILE              answers for 'assign x input', one per line ('-' = stdin)\n"
+        "  --max-cycles N            stop after N cycles (default %d)\n"
+        "  --report text|json        report format (default text)\n"
+        "  --trace FILE              write every log line as '<cycle> <text>' ('-' = stdout)\n"
+        "  --verbose                 keep the simulator's debug output on stdout\n"
+        "Exit status: 0 all processes finished, 2 stopped early, 1 error.\n",
+        DEFAULT_MAX_CYCLES);
+}
+
+static int parse_algorithm(const char* name, SchedulingAlgorithm* algorithm) {
+    static const struct { const char* name; SchedulingAlgorithm algorithm; } names[] = {
+        {"fcfs", FCFS}, {"rr", RR}, {"mlfq", MLFQ}, {"cfs", CFS}
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcasecmp(name, names[i].name) == 0) {
+            *algorithm = names[i].algorithm;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_count(const char* text, int minimum, int* value) {
+    char* end;
+    long parsed = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed < minimum || parsed > 0x7fffffff) return -1;
+    *value = (int)parsed;
+    return 0;
+}
+
+static int parse_options(int argc, char** argv, RunOptions* options) {
+    *options = (RunOptions){FCFS, 2, 1, 0, 1, 0, 1, NULL, NULL, DEFAULT_MAX_CYCLES, 0, NULL, 0};
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(stdout);
+            exit(RUN_COMPLETED);
+        }
+        if (strcmp(arg, "--event-driven") == 0) {
+            options->event_driven = 1;
+            continue;
+        }
+        if (strcmp(arg, "--verbose") == 0) {
+            options->verbose = 1;
+            continue;
+        }
+        if (strcmp(arg, "--parallel") == 0) {
+            options->parallel = 1;
+            continue;
+        }
+        if (strcmp(arg, "--no-steal") == 0) {
+            options->work_stealing = 0;
+            continue;
+        }
+        // Everything else takes a value
+        if (i + 1 >= argc) {
+            fprintf(stderr, "[ERROR] %s needs a value\n", arg);
+            return -1;
+        }
+        const char* value = argv[++i];
+        int bad = 0;
+        if (strcmp(arg, "--algo") == 0) bad = parse_algorithm(value, &options->algorithm);
+        else if (strcmp(arg, "--quantum") == 0) bad = parse_count(value, 1, &options->quantum);
+        else if (strcmp(arg, "--cpus") == 0) bad = parse_count(value, 1, &options->cpus);
+        else if (strcmp(arg, "--ipc") == 0) bad = parse_count(value, 1, &options->instructions_per_cycle);
+        else if (strcmp(arg, "--max-cycles") == 0) bad = parse_count(value, 0, &options->max_cycles);
+        else if (strcmp(arg, "--manifest") == 0) options->manifest = value;
+        else if (strcmp(arg, "--input") == 0) options->input = value;
+        else if (strcmp(arg, "--trace") == 0) options->trace = value;
+        else if (strcmp(arg, "--report") == 0) {
+            if (strcmp(value, "json") == 0) options->json = 1;
+            else if (strcmp(value, "text") == 0) options->json = 0;
+            else bad = -1;
+        } else {
+            fprintf(stderr, "[ERROR] Unknown option %s\n", arg);
+            return -1;
+        }
+        if (bad) {
+            fprintf(stderr, "[ERROR] Bad value for %s: %s\n", arg, value);
+            return -1;
+        }
+    }
+    if (!options->manifest) {
+        fprintf(stderr, "[ERROR] --manifest is required\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void trace_line(const SchedulerEvent* event, void* user_data) {
+    fprintf((FILE*)user_data, "%d %s\n", event->cycle, event->text);
+}
+
+// Nothing can run now and nothing is scheduled to wake anyone: the blocked
+// processes wait for input no one will give, or for each other
+static int run_stalled() {
+    int total = get_total_processes();
+    return total > 0 && !has_pending_processes() && total == scheduler->blocked_queue.size &&
+        next_event_time(scheduler) < 0;
+}
+
+static void json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+        else if ((unsigned char)*c < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+// Numbers (a trailing % is dropped) go out bare, anything else as a string
+static void json_value(FILE* out, const char* text) {
+    char* end;
+    strtod(text, &end);
+    int numeric = (*text >= '0' && *text <= '9') || (*text == '-' && text[1] >= '0' && text[1] <= '9');
+    if (numeric && (*end == '\0' || strcmp(end, "%") == 0)) fprintf(out, "%.*s", (int)(end - text), text);
+    else json_string(out, text);
+}
+
+// "key=value" fields separated by any of separators as JSON members
+static void json_fields(FILE* out, const char* fields, const char* separators) {
+    char* copy = strdup(fields);
+    if (!copy) {
+        fprintf(stderr, "Failed to allocate the report!\n");
+        exit(EXIT_FAILURE);
+    }
+    int first = 1;
+    char* save = NULL;
+    for (char* field = strtok_r(copy, separators, &save); field; field = strtok_r(NULL, separators, &save)) {
+        char* equals = strchr(field, '=');
+        if (!equals) continue;
+        *equals = '\0';
+        fprintf(out, "%s", first ? "" : ", ");
+        json_string(out, field);
+        fprintf(out, ": ");
+        json_value(out, equals + 1);
+        first = 0;
+    }
+    free(copy);
+}
+
+// get_device_stats/get_cpu_state: one "name: key=value ..." line per device or CPU
+static void json_sections(FILE* out, const char* stats, const char* separators) {
+    char* copy = strdup(stats);
+    if (!copy) {
+        fprintf(stderr, "Failed to allocate the report!\n");
+        exit(EXIT_FAILURE);
+    }
+    int first = 1;
+    char* save = NULL;
+    for (char* line = strtok_r(copy, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char* colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+        fprintf(out, "%s\n    ", first ? "" : ",");
+        json_string(out, line);
+        fprintf(out, ": {");
+        json_fields(out, colon + 1, separators);
+        fprintf(out, "}");
+        first = 0;
+    }
+    free(copy);
+}
+
+static void report(FILE* out, const RunOptions* options, const char* status, int loaded, int failed) {
+    const char* metrics = get_metrics();
+    const char* cpu_state = get_cpu_state();
+    const char* devices = get_device_stats();
+    if (!options->json) {
+        fprintf(out, "status=%s\nalgorithm=%s\nquantum=%d\ncpus=%d\nparallel=%d\nwork_stealing=%d\n"
+            "loaded=%d\nfailed=%d\nremaining=%d\n",
+            status, get_algorithm_name(), options->quantum, options->cpus, options->parallel,
+            options->work_stealing, loaded, failed, get_total_processes() + pending_list.count);
+        fprintf(out, "%s%s%s", metrics, cpu_state, devices);
+        return;
+    }
+    fprintf(out, "{\n  \"status\": \"%s\",\n  \"algorithm\": ", status);
+    json_string(out, get_algorithm_name());
+    fprintf(out, ",\n  \"quantum\": %d,\n  \"cpus\": %d,\n  \"parallel\": %d,\n  \"work_stealing\": %d,\n"
+        "  \"manifest\": ", options->quantum, options->cpus, options->parallel, options->work_stealing);
+    json_string(out, options->manifest);
+    fprintf(out, ",\n  \"loaded\": %d,\n  \"failed\": %d,\n  \"remaining\": %d,\n  \"metrics\": {",
+        loaded, failed, get_total_processes() + pending_list.count);
+    json_fields(out, metrics, "\n");
+    fprintf(out, "},\n  \"per_cpu\": {");
+    json_sections(out, cpu_state, ", ");
+    fprintf(out, "\n  },\n  \"devices\": {");
+    json_sections(out, devices, " ");
+    fprintf(out, "\n  }\n}\n");
+}
+
+int main(int argc, char** argv) {
+    RunOptions options;
+    if (parse_options(argc, argv, &options) < 0) {
+        usage(stderr);
+        return RUN_ERROR;
+    }
+
+    // Keep the real stdout for the report before silencing the simulator
+    FILE* out = stdout;
+    if (!options.verbose) {
+        int fd = dup(STDOUT_FILENO);
+        out = fd >= 0 ? fdopen(fd, "w") : NULL;
+        if (!out || !freopen("/dev/null", "w", stdout)) {
+            fprintf(stderr, "[ERROR] Cannot redirect the simulator output\n");
+            return RUN_ERROR;
+        }
+    }
+
+    FILE* trace = NULL;
+    int trace_id = -1;
+    if (options.trace) {
+        trace = strcmp(options.trace, "-") == 0 ? out : fopen(options.trace, "w");
+        if (!trace) {
+            fprintf(stderr, "[ERROR] Cannot open trace file %s\n", options.trace);
+            return RUN_ERROR;
+        }
+        trace_id = subscribe_events(EVENT_MASK(EVENT_LOG), trace_line, trace);
+    }
+
+    api_init_scheduler(options.algorithm, options.quantum);
+    if (options.cpus > 1) api_set_cpu_count(options.cpus);
+    if (!options.work_stealing) api_set_work_stealing(0);
+    if (options.parallel) api_set_parallel(1);
+    if (options.event_driven) api_set_event_driven(1);
+    if (!options.verbose) api_set_verbose(0);
+    if (options.instructions_per_cycle > 1) api_set_instructions_per_cycle(options.instructions_per_cycle);
+    if (options.input && load_input_script(options.input) < 0) {
+        fprintf(stderr, "[ERROR] Cannot open input script %s\n", options.input);
+        return RUN_ERROR;
+    }
+
+    // load_manifest reports key=value lines, then one line per bad manifest line
+    const char* loaded_report = load_manifest(options.manifest);
+    int loaded = 0, failed = 0;
+    for (const char* line = loaded_report; line && *line; ) {
+        const char* end = strchr(line, '\n');
+        int length = end ? (int)(end - line) : (int)strlen(line);
+        if (strncmp(line, "error=", 6) == 0) {
+            fprintf(stderr, "[ERROR] %.*s\n", length - 6, line + 6);
+            return RUN_ERROR;
+        }
+        if (strncmp(line, "loaded=", 7) == 0) loaded = atoi(line + 7);
+        else if (strncmp(line, "failed=", 7) == 0) failed = atoi(line + 7);
+        else if (strncmp(line, "line ", 5) == 0) fprintf(stderr, "[WARN] %.*s\n", length, line);
+        line = end ? end + 1 : line + length;
+    }
+
+    const char* status = "completed";
+    while (get_total_processes() > 0 || has_pending_processes()) {
+        if (get_clock_cycle() >= options.max_cycles) {
+            status = "max_cycles";
+            break;
+        }
+        step_execution();
+        if (run_stalled()) {
+            status = "stalled";
+            break;
+        }
+    }
+
+    if (trace) {
+        unsubscribe_events(trace_id);
+        if (trace != out) fclose(trace);
+    }
+    report(out, &options, status, loaded, failed);
+    fflush(out);
+    return strcmp(status, "completed") == 0 ? RUN_COMPLETED : RUN_INCOMPLETE;
+}
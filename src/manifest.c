@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "manifest.h"
+#include "cfs.h"
+
+#define INITIAL_MANIFEST_CAPACITY 64
+
+void manifest_error(Manifest* manifest, int line, const char* format, ...) {
+    if (manifest->error_count < MANIFEST_MAX_ERRORS) {
+        char* out = manifest->errors[manifest->error_count];
+        size_t size = sizeof(manifest->errors[0]);
+        int written = snprintf(out, size, "line %d: ", line);
+        va_list args;
+        va_start(args, format);
+        vsnprintf(out + written, size - written, format, args);
+        va_end(args);
+    }
+    manifest->error_count++;
+}
+
+// Nice level whose CFS weight is closest to weight
+static int nice_for_weight(long weight) {
+    int best = 0;
+    long best_distance = -1;
+    for (int nice = CFS_MIN_NICE; nice <= CFS_MAX_NICE; nice++) {
+        long distance = labs(cfs_weight_for_nice(nice) - weight);
+        if (best_distance < 0 || distance < best_distance) {
+            best = nice;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+static bool parse_int(const char* text, long min, long max, int* out) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value < min || value > max) return false;
+    *out = (int)value;
+    return true;
+}
+
+// Program path as written, or relative to the manifest's directory if it exists there
+static void resolve_path(const char* manifest_path, const char* program, char* out, size_t size) {
+    snprintf(out, size, "%s", program);
+    if (program[0] == '/' || program[0] == '\\') return;
+    const char* slash = strrchr(manifest_path, '/');
+    if (!slash) return;
+    char candidate[MANIFEST_MAX_PATH];
+    int written = snprintf(candidate, sizeof(candidate), "%.*s/%s", (int)(slash - manifest_path), manifest_path, program);
+    if (written <= 0 || (size_t)written >= sizeof(candidate)) return;
+    FILE* probe = fopen(candidate, "r");
+    if (probe) {
+        fclose(probe);
+        snprintf(out, size, "%s", candidate);
+    }
+}
+
+static bool parse_option(Manifest* manifest, ManifestEntry* entry, const char* option) {
+    const char* equals = strchr(option, '=');
+    if (!equals) {
+        manifest_error(manifest, entry->line, "expected key=value, got '%s'", option);
+        return false;
+    }
+    size_t key_length = equals - option;
+    const char* value = equals + 1;
+    int number;
+    if (key_length == 8 && strncmp(option, "priority", 8) == 0) {
+        if (!parse_int(value, 1, 4, &number)) {
+            manifest_error(manifest, entry->line, "priority must be 1-4");
+            return false;
+        }
+        entry->priority = number;
+    } else if (key_length == 4 && strncmp(option, "nice", 4) == 0) {
+        if (!parse_int(value, CFS_MIN_NICE, CFS_MAX_NICE, &number)) {
+            manifest_error(manifest, entry->line, "nice must be %d to %d", CFS_MIN_NICE, CFS_MAX_NICE);
+            return false;
+        }
+        entry->nice = number;
+        entry->has_nice = true;
+    } else if (key_length == 6 && strncmp(option, "weight", 6) == 0) {
+        if (!parse_int(value, 1, 1000000000, &number)) {
+            manifest_error(manifest, entry->line, "weight must be positive");
+            return false;
+        }
+        entry->nice = nice_for_weight(number);
+        entry->has_nice = true;
+    } else if (key_length == 6 && strncmp(option, "repeat", 6) == 0) {
+        if (!parse_int(value, 1, MANIFEST_MAX_REPEAT, &number)) {
+            manifest_error(manifest, entry->line, "repeat must be 1-%d", MANIFEST_MAX_REPEAT);
+            return false;
+        }
+        entry->repeat = number;
+    } else if (key_length == 8 && strncmp(option, "deadline", 8) == 0) {
+        // Not an error: the entry still loads, there is just no deadline scheduler to honour it
+        manifest_error(manifest, entry->line, "deadline ignored, no scheduler uses deadlines");
+    } else {
+        manifest_error(manifest, entry->line, "unknown option '%.*s'", (int)key_length, option);
+        return false;
+    }
+    return true;
+}
+
+// Read every entry of the manifest at path; -1 if it cannot be opened.
+// Malformed lines are recorded in manifest->errors and skipped.
+int manifest_parse(const char* path, Manifest* manifest) {
+    memset(manifest, 0, sizeof(*manifest));
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+
+    char line[1024];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char* program = strtok(line, " \t");
+        if (!program || program[0] == '#') continue;
+
+        ManifestEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.line = line_number;
+        entry.repeat = 1;
+        char* arrival = strtok(NULL, " \t");
+        if (!arrival || !parse_int(arrival, 0, 1000000000, &entry.arrival)) {
+            manifest_error(manifest, line_number, "expected '<program> <arrival>'");
+            continue;
+        }
+        bool ok = true;
+        char* option;
+        while (ok && (option = strtok(NULL, " \t")) != NULL) {
+            ok = parse_option(manifest, &entry, option);
+        }
+        if (!ok) continue;
+        resolve_path(path, program, entry.path, sizeof(entry.path));
+
+        if (manifest->count == manifest->capacity) {
+            int capacity = manifest->capacity ? manifest->capacity * 2 : INITIAL_MANIFEST_CAPACITY;
+            ManifestEntry* grown = realloc(manifest->entries, capacity * sizeof(ManifestEntry));
+            if (!grown) {
+                fprintf(stderr, "Failed to grow manifest!\n");
+                exit(EXIT_FAILURE);
+            }
+            manifest->entries = grown;
+            manifest->capacity = capacity;
+        }
+        manifest->entries[manifest->count++] = entry;
+    }
+    fclose(file);
+    return manifest->count;
+}
+
+void manifest_free(Manifest* manifest) {
+    free(manifest->entries);
+    manifest->entries = NULL;
+    manifest->count = 0;
+    manifest->capacity = 0;
+}
@@ -6,8 +6,13 @@
 #include "interpreter.h"
 #include "pcb.h"
 #include "queue.h"
+#include "events.h"
 
 #include <assert.h>
+#include <pthread.h>
+
+// Memory words are written from every CPU thread during parallel execution
+static pthread_mutex_t memory_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 void init_memory(Memory* memory) {
@@ -19,29 +24,45 @@ void init_memory(Memory* memory) {
         memory->words[i].process_id = 0;
     }
     memory->next_free_word = 0;
+    memory->segment_count = 0;
     printf("[DEBUG] Memory initialized.\n");
 }
 
-int allocate_memory(Memory* memory, PCB* pcb, int size) {
-    printf("[DEBUG] Request to allocate %d units for PID %d.\n", size, pcb->pid);
-    if (!memory || !pcb || size <= 0 || size > MEMORY_SIZE) {
-        printf("[ERROR] Invalid arguments or size too large.\n");
-        return -1;
-    }
-
+// First free run of size words, -1 if there is none; call with memory_lock held
+static int find_free_run(const Memory* memory, int size) {
     int start = -1, count = 0;
     for (int i = 0; i < MEMORY_SIZE; i++) {
         if (memory->words[i].process_id == 0) {
             if (count == 0) start = i;
             count++;
-            if (count == size) break;
+            if (count == size) return start;
         } else {
             count = 0;
             start = -1;
         }
     }
+    return -1;
+}
+
+static void clear_word(MemoryWord* word) {
+    free(word->name);
+    free(word->data);
+    word->name = NULL;
+    word->data = NULL;
+    word->process_id = 0;
+}
 
-    if (count < size) {
+int allocate_memory(Memory* memory, PCB* pcb, int size) {
+    printf("[DEBUG] Request to allocate %d units for PID %d.\n", size, pcb->pid);
+    if (!memory || !pcb || size <= 0 || size > MEMORY_SIZE) {
+        printf("[ERROR] Invalid arguments or size too large.\n");
+        return -1;
+    }
+
+    pthread_mutex_lock(&memory_lock);
+    int start = find_free_run(memory, size);
+    if (start < 0) {
+        pthread_mutex_unlock(&memory_lock);
         printf("[ERROR] Not enough contiguous memory for PID %d.\n", pcb->pid);
         return -1;
     }
@@ -49,6 +70,8 @@ int allocate_memory(Memory* memory, PCB* pcb, int size) {
     for (int i = start; i < start + size; i++) {
         memory->words[i].process_id = pcb->pid;
     }
+    pthread_mutex_unlock(&memory_lock);
+    event_emit(EVENT_MEMORY, start, start + size - 1, pcb->pid);
     set_pcb_memory_bounds(pcb, start, start + size - 1);
     printf("[DEBUG] Allocated memory for PID %d from %d to %d.\n", pcb->pid, start, start + size - 1);
     return start;
@@ -57,15 +80,21 @@ int allocate_memory(Memory* memory, PCB* pcb, int size) {
 void deallocate_memory(Memory* memory, PCB* pcb) {
     printf("[DEBUG] Deallocating memory for PID %d...\n", pcb->pid);
     if (!memory || !pcb) return;
+    int first = -1, last = -1;
+    pthread_mutex_lock(&memory_lock);
     for (int i = 0; i < MEMORY_SIZE; i++) {
         if (memory->words[i].process_id == pcb->pid) {
-            free(memory->words[i].name);
-            free(memory->words[i].data);
-            memory->words[i].name = NULL;
-            memory->words[i].data = NULL;
-            memory->words[i].process_id = 0;
+            clear_word(&memory->words[i]);
+            if (first < 0) first = i;
+            last = i;
         }
     }
+    pthread_mutex_unlock(&memory_lock);
+    if (first >= 0) event_emit(EVENT_MEMORY, first, last, 0);
+    if (pcb->text_base >= 0) {
+        detach_text_segment(memory, pcb->text_base);
+        pcb->text_base = -1;
+    }
     printf("[DEBUG] Deallocated memory for PID %d.\n", pcb->pid);
 }
 
@@ -75,6 +104,7 @@ void write_memory(Memory* memory, int address, const char* name, const char* dat
     assert(memory != NULL);
     assert(address >= 0 && address < MEMORY_SIZE);
 
+    pthread_mutex_lock(&memory_lock);
     free(memory->words[address].name);
     free(memory->words[address].data);
 
@@ -87,6 +117,8 @@ void write_memory(Memory* memory, int address, const char* name, const char* dat
         printf("[ERROR] Failed to allocate memory for data at address %d.\n", address);
     }
     memory->words[address].process_id = process_id;
+    pthread_mutex_unlock(&memory_lock);
+    event_emit(EVENT_MEMORY, address, address, process_id);
 
     printf("[DEBUG] Wrote: name='%s', data='%s' at %d.\n", name, data, address);
 }
@@ -144,3 +176,81 @@ bool is_memory_available(const Memory* memory, int size) {
     }
     return false;
 }
+
+static TextSegment* segment_at(Memory* memory, int base) {
+    for (int i = 0; i < memory->segment_count; i++) {
+        if (memory->segments[i].base == base) return &memory->segments[i];
+    }
+    return NULL;
+}
+
+// Base of the shared text for key, mapping the instructions the first time; -1 if they do not fit
+int attach_text_segment(Memory* memory, const void* key, char** instructions, int count) {
+    if (!memory || count <= 0 || count > MEMORY_SIZE) return -1;
+    pthread_mutex_lock(&memory_lock);
+    for (int i = 0; key && i < memory->segment_count; i++) {
+        TextSegment* segment = &memory->segments[i];
+        if (segment->key == key && segment->size == count) {
+            segment->refs++;
+            pthread_mutex_unlock(&memory_lock);
+            return segment->base;
+        }
+    }
+    int base = memory->segment_count < MAX_TEXT_SEGMENTS ? find_free_run(memory, count) : -1;
+    if (base < 0) {
+        pthread_mutex_unlock(&memory_lock);
+        printf("[ERROR] Not enough contiguous memory for a %d-word text segment.\n", count);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        MemoryWord* word = &memory->words[base + i];
+        word->name = strdup("instruction");
+        word->data = strdup(instructions[i]);
+        word->process_id = MEMORY_SHARED_PID;
+    }
+    memory->segments[memory->segment_count++] = (TextSegment){key, base, count, 1};
+    pthread_mutex_unlock(&memory_lock);
+    event_emit(EVENT_MEMORY, base, base + count - 1, MEMORY_SHARED_PID);
+    printf("[DEBUG] Mapped shared text at [%d - %d].\n", base, base + count - 1);
+    return base;
+}
+
+// Drop one process's reference; the words are freed with the last one
+void detach_text_segment(Memory* memory, int base) {
+    if (!memory) return;
+    pthread_mutex_lock(&memory_lock);
+    TextSegment* segment = segment_at(memory, base);
+    int freed = 0;
+    if (segment && --segment->refs == 0) {
+        freed = segment->size;
+        for (int i = base; i < base + segment->size; i++) {
+            clear_word(&memory->words[i]);
+        }
+        *segment = memory->segments[--memory->segment_count];
+    }
+    pthread_mutex_unlock(&memory_lock);
+    if (freed > 0) event_emit(EVENT_MEMORY, base, base + freed - 1, 0);
+}
+
+// The shared segment covering address, NULL for private or free words
+const TextSegment* find_text_segment(const Memory* memory, int address) {
+    if (!memory) return NULL;
+    for (int i = 0; i < memory->segment_count; i++) {
+        const TextSegment* segment = &memory->segments[i];
+        if (address >= segment->base && address < segment->base + segment->size) return segment;
+    }
+    return NULL;
+}
+
+MemoryUsage get_memory_usage(const Memory* memory) {
+    MemoryUsage usage = {0, 0, 0, 0};
+    if (!memory) return usage;
+    for (int i = 0; i < MEMORY_SIZE; i++) {
+        int owner = memory->words[i].process_id;
+        if (owner == MEMORY_SHARED_PID) usage.shared++;
+        else if (owner == 0) usage.free_words++;
+        else usage.private_words++;
+    }
+    usage.segments = memory->segment_count;
+    return usage;
+}
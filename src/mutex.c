@@ -1,6 +1,9 @@
 #include "mutex.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "globals.h"
 #include "interpreter.h"
 #include "memory.h"
@@ -11,98 +14,328 @@
 extern Scheduler* scheduler;
 
 #define INITIAL_QUEUE_CAPACITY 10
+#define INITIAL_RESOURCE_CAPACITY 8
+#define INITIAL_NAME_TABLE_SIZE 16   // power of two, kept at most half full
+
+// Serializes sem_acquire/sem_signal when CPUs execute on separate threads
+static pthread_mutex_t resource_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// FNV-1a
+static uint32_t hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding the name, or the empty slot where it would go
+static int name_slot(const ResourceManager* manager, const char* name) {
+    int mask = manager->name_table_size - 1;
+    int slot = (int)(hash_name(name) & (uint32_t)mask);
+    while (manager->name_table[slot] != -1 &&
+           strcmp(manager->mutexes[manager->name_table[slot]].name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void grow_name_table(ResourceManager* manager) {
+    int new_size = manager->name_table_size * 2;
+    int* new_table = malloc(new_size * sizeof(int));
+    if (!new_table) {
+        fprintf(stderr, "Failed to grow resource name table!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < new_size; i++) new_table[i] = -1;
+    free(manager->name_table);
+    manager->name_table = new_table;
+    manager->name_table_size = new_size;
+    for (int id = 0; id < manager->count; id++) {
+        manager->name_table[name_slot(manager, manager->mutexes[id].name)] = id;
+    }
+}
+
+static void init_mutex(Mutex* mutex, const char* name, int initial_count) {
+    strncpy(mutex->name, name, sizeof(mutex->name) - 1);
+    mutex->name[sizeof(mutex->name) - 1] = '\0';
+    mutex->initial_count = initial_count;
+    mutex->available = initial_count;
+    mutex->locked = 0;
+    mutex->owner_pid = -1;
+    mutex->holder_count = 0;
+    mutex->holder_capacity = initial_count < INITIAL_QUEUE_CAPACITY ? initial_count : INITIAL_QUEUE_CAPACITY;
+    mutex->holders = malloc(mutex->holder_capacity * sizeof(PCB*));
+    mutex->queue_size = 0;
+    for (int i = 0; i < WAIT_LEVELS; i++) {
+        mutex->wait_head[i] = NULL;
+        mutex->wait_tail[i] = NULL;
+    }
+    mutex->wait_bitmap = 0;
+}
+
+static int find_resource_locked(ResourceManager* manager, const char* name) {
+    if (!manager || !name || !manager->name_table) return RESOURCE_INVALID;
+    return manager->name_table[name_slot(manager, name)];
+}
+
+static int register_resource_locked(ResourceManager* manager, const char* name, int initial_count) {
+    if (!manager || !name || !*name || !manager->mutexes) return RESOURCE_INVALID;
+    if (initial_count < 1) initial_count = 1;
+
+    int existing = find_resource_locked(manager, name);
+    if (existing != RESOURCE_INVALID) {
+        Mutex* mutex = &manager->mutexes[existing];
+        if (mutex->initial_count != initial_count) {
+            printf("[WARN] Resource [%s] already declared with count %d; ignoring count %d.\n",
+                name, mutex->initial_count, initial_count);
+        }
+        return existing;
+    }
+
+    if (manager->count >= manager->capacity) {
+        int new_capacity = manager->capacity * 2;
+        Mutex* new_mutexes = realloc(manager->mutexes, new_capacity * sizeof(Mutex));
+        if (!new_mutexes) {
+            fprintf(stderr, "Failed to realloc resource table!\n");
+            exit(EXIT_FAILURE);
+        }
+        manager->mutexes = new_mutexes;
+        manager->capacity = new_capacity;
+    }
+    if ((manager->count + 1) * 2 > manager->name_table_size) {
+        grow_name_table(manager);
+    }
+
+    int id = manager->count++;
+    init_mutex(&manager->mutexes[id], name, initial_count);
+    manager->name_table[name_slot(manager, name)] = id;
+    printf("[DEBUG] Registered resource [%s] as id %d with %d unit(s).\n", name, id, initial_count);
+    return id;
+}
 
 void init_resource_manager(ResourceManager* manager) {
     if (!manager) return;
     printf("[DEBUG] Resource manager initialized.\n");
-    for (int i = 0; i < NUM_RESOURCES; i++) {
-        manager->mutexes[i].locked = 0;
-        manager->mutexes[i].owner_pid = -1;
-        manager->mutexes[i].queue_size = 0;
-        manager->mutexes[i].queue_capacity = INITIAL_QUEUE_CAPACITY;
-        manager->mutexes[i].waiting_queue = malloc(INITIAL_QUEUE_CAPACITY * sizeof(PCB*));
+    manager->count = 0;
+    manager->capacity = INITIAL_RESOURCE_CAPACITY;
+    manager->mutexes = malloc(INITIAL_RESOURCE_CAPACITY * sizeof(Mutex));
+    manager->name_table_size = INITIAL_NAME_TABLE_SIZE;
+    manager->name_table = malloc(INITIAL_NAME_TABLE_SIZE * sizeof(int));
+    for (int i = 0; i < INITIAL_NAME_TABLE_SIZE; i++) manager->name_table[i] = -1;
+    manager->deadlock_policy = DEADLOCK_REPORT_ONLY;
+    manager->priority_inheritance = 1;
+    invalidate_priority_inversions();
+
+    // Ids 0..2 stay fixed so RESOURCE_USER_INPUT etc. keep working
+    register_resource_locked(manager, "userInput", 1);
+    register_resource_locked(manager, "userOutput", 1);
+    register_resource_locked(manager, "file", 1);
+}
+
+void destroy_resource_manager(ResourceManager* manager) {
+    if (!manager || !manager->mutexes) return;
+    for (int i = 0; i < manager->count; i++) {
+        free(manager->mutexes[i].holders);
+    }
+    free(manager->mutexes);
+    free(manager->name_table);
+    manager->mutexes = NULL;
+    manager->name_table = NULL;
+    manager->count = 0;
+    manager->capacity = 0;
+    manager->name_table_size = 0;
+}
+
+// Declare a named semaphore (or return the id of an existing one)
+int register_resource(ResourceManager* manager, const char* name, int initial_count) {
+    pthread_mutex_lock(&resource_lock);
+    int id = register_resource_locked(manager, name, initial_count);
+    pthread_mutex_unlock(&resource_lock);
+    return id;
+}
+
+ResourceType find_resource(ResourceManager* manager, const char* name) {
+    pthread_mutex_lock(&resource_lock);
+    int id = find_resource_locked(manager, name);
+    pthread_mutex_unlock(&resource_lock);
+    return id;
+}
+
+// count_priority_inversions runs every cycle; it recounts only after a holder,
+// waiter or priority changed since the last count
+static int inversions_stale = 1;
+static int cached_inversions = 0;
+
+void invalidate_priority_inversions() {
+    __atomic_store_n(&inversions_stale, 1, __ATOMIC_RELAXED);
+}
+
+static bool is_holder(const Mutex* mutex, const PCB* pcb) {
+    for (int i = 0; i < mutex->holder_count; i++) {
+        if (mutex->holders[i] == pcb) return true;
     }
+    return false;
 }
 
-bool sem_wait(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
-    if (!manager || !pcb || resource >= NUM_RESOURCES) return false;
+static void add_holder(Mutex* mutex, PCB* pcb) {
+    if (mutex->holder_count >= mutex->holder_capacity) {
+        mutex->holder_capacity = mutex->holder_capacity > 0 ? mutex->holder_capacity * 2 : 1;
+        PCB** new_holders = realloc(mutex->holders, mutex->holder_capacity * sizeof(PCB*));
+        if (!new_holders) {
+            fprintf(stderr, "Failed to realloc holders!\n");
+            exit(EXIT_FAILURE);
+        }
+        mutex->holders = new_holders;
+    }
+    mutex->holders[mutex->holder_count++] = pcb;
+    invalidate_priority_inversions();
+    mutex->available--;
+    mutex->locked = mutex->available == 0;
+    mutex->owner_pid = mutex->holders[0]->pid;
+}
+
+// Drop one unit held by pcb; false if it holds none
+static bool remove_holder(Mutex* mutex, const PCB* pcb) {
+    for (int i = 0; i < mutex->holder_count; i++) {
+        if (mutex->holders[i] == pcb) {
+            for (int j = i; j < mutex->holder_count - 1; j++) {
+                mutex->holders[j] = mutex->holders[j + 1];
+            }
+            mutex->holder_count--;
+            invalidate_priority_inversions();
+            mutex->available++;
+            mutex->locked = mutex->available == 0;
+            mutex->owner_pid = mutex->holder_count > 0 ? mutex->holders[0]->pid : -1;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void check_deadlock(ResourceManager* manager, PCB* waiter, Logger* logger);
+static void forget_deadlock(PCB* pcb);
+static void propagate_priority(ResourceManager* manager, PCB* pcb, int depth);
+
+// Waiters are served in priority order, FIFO among equal priorities.
+// The bucket is fixed at insert time, so a later priority change needs remove + insert.
+static void insert_waiter(Mutex* mutex, PCB* pcb) {
+    int level = pcb_priority(pcb) - 1;
+    if (level < 0) level = 0;
+    if (level >= WAIT_LEVELS) level = WAIT_LEVELS - 1;
+
+    pcb->wait_level = level;
+    pcb->wait_next = NULL;
+    pcb->wait_prev = mutex->wait_tail[level];
+    if (mutex->wait_tail[level]) mutex->wait_tail[level]->wait_next = pcb;
+    else mutex->wait_head[level] = pcb;
+    mutex->wait_tail[level] = pcb;
+    mutex->wait_bitmap |= 1u << level;
+    mutex->queue_size++;
+    invalidate_priority_inversions();
+}
+
+// Caller must know pcb is waiting on this mutex (pcb->waiting_on)
+static bool remove_waiter(Mutex* mutex, PCB* pcb) {
+    int level = pcb->wait_level;
+    if (level < 0) return false;
+
+    if (pcb->wait_prev) pcb->wait_prev->wait_next = pcb->wait_next;
+    else mutex->wait_head[level] = pcb->wait_next;
+    if (pcb->wait_next) pcb->wait_next->wait_prev = pcb->wait_prev;
+    else mutex->wait_tail[level] = pcb->wait_prev;
+    if (!mutex->wait_head[level]) mutex->wait_bitmap &= ~(1u << level);
+
+    pcb->wait_level = -1;
+    pcb->wait_prev = NULL;
+    pcb->wait_next = NULL;
+    mutex->queue_size--;
+    invalidate_priority_inversions();
+    return true;
+}
+
+// Highest-priority, longest-waiting process, or NULL
+static PCB* first_waiter(const Mutex* mutex) {
+    if (!mutex->wait_bitmap) return NULL;
+    return mutex->wait_head[__builtin_ctz(mutex->wait_bitmap)];
+}
+
+// Holders of the semaphore inherit from its waiters; recompute them after the wait list changed
+static void propagate_to_holders(ResourceManager* manager, Mutex* mutex, int depth) {
+    for (int h = 0; h < mutex->holder_count; h++) {
+        propagate_priority(manager, mutex->holders[h], depth);
+    }
+}
+
+static bool sem_wait_locked(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
+    if (!manager || !pcb || resource < 0 || resource >= manager->count) return false;
     Mutex* mutex = &manager->mutexes[resource];
-    printf("[DEBUG] sem_wait called: PID=%d, Resource=%s, Locked=%d, Owner=%d\n",
-        pcb->pid, get_resource_name(resource), mutex->locked, mutex->owner_pid);
+    printf("[DEBUG] sem_acquire called: PID=%d, Resource=%s, Available=%d/%d, Owner=%d\n",
+        pcb->pid, get_resource_name(resource), mutex->available, mutex->initial_count, mutex->owner_pid);
 
     char log_msg[256];
 
-    if (!mutex->locked || mutex->owner_pid == pcb->pid) {
-        mutex->locked = 1;
-        mutex->owner_pid = pcb->pid;
+    // sem_signal already handed this process a unit while it was blocked here
+    if (pcb->granted_resource == resource) {
+        pcb->granted_resource = -1;
+        printf("[DEBUG] PID=%d resumes holding resource %s handed over by sem_signal.\n",
+            pcb->pid, get_resource_name(resource));
+        return true;
+    }
+
+    // A binary semaphore stays re-entrant for its holder, as before
+    if (mutex->initial_count == 1 && is_holder(mutex, pcb)) {
+        printf("[DEBUG] PID=%d already holds resource %s.\n", pcb->pid, get_resource_name(resource));
+        return true;
+    }
+
+    if (mutex->available > 0) {
+        add_holder(mutex, pcb);
         printf("[DEBUG] --> pcb->pid = %d\n", pcb->pid);
         snprintf(log_msg, sizeof(log_msg),
             "[Event] [Program: %s | PID %d] Acquired [%s]",
             pcb->program_name, pcb->pid, get_resource_name(resource));
         log_event(logger, log_msg);
-        printf("[DEBUG] PID=%d acquired mutex on resource %s without blocking; no re-add to ready queue done.\n",
-            pcb->pid, get_resource_name(resource));
+        printf("[DEBUG] PID=%d acquired resource %s without blocking (%d unit(s) left); no re-add to ready queue done.\n",
+            pcb->pid, get_resource_name(resource), mutex->available);
         return true;
     } else {
-        if (mutex->queue_size >= mutex->queue_capacity) {
-            mutex->queue_capacity *= 2;
-            PCB** new_queue = realloc(mutex->waiting_queue,
-                                      mutex->queue_capacity * sizeof(PCB*));
-            if (!new_queue) {
-                fprintf(stderr, "Failed to realloc waiting_queue!\n");
-                exit(EXIT_FAILURE);
-            }
-            mutex->waiting_queue = new_queue;
-        }
-
-        int insert_pos = 0;
-        for (; insert_pos < mutex->queue_size; insert_pos++) {
-            if (pcb->priority < mutex->waiting_queue[insert_pos]->priority) break;
-        }
-
         // ✅ Check if it's already in the waiting queue
-        bool already_waiting = false;
-        for (int i = 0; i < mutex->queue_size; i++) {
-            if (mutex->waiting_queue[i] == pcb) {
-                already_waiting = true;
-                break;
-            }
-        }
+        bool already_waiting = pcb->waiting_on == resource && pcb->wait_level >= 0;
 
         if (!already_waiting) {
-            for (int i = mutex->queue_size; i > insert_pos; i--) {
-                mutex->waiting_queue[i] = mutex->waiting_queue[i - 1];
-            }
-            mutex->waiting_queue[insert_pos] = pcb;
-            mutex->queue_size++;
+            insert_waiter(mutex, pcb);
+            pcb->waiting_on = resource;
             set_pcb_state(pcb, BLOCKED);
             printf("[DEBUG] set_pcb_state called for PID=%d | priority=%d | program_name=%s\n",
-                   pcb->pid, pcb->priority, pcb->program_name);
+                   pcb->pid, pcb_priority(pcb), pcb->program_name);
             printf("[DEBUG] Set PID=%d state to BLOCKED after being queued on resource %s\n", pcb->pid, get_resource_name(resource));
         } else {
             printf("[DEBUG] PID=%d is already in waiting queue for resource %s; skipping insert.\n",
                    pcb->pid, get_resource_name(resource));
         }
 
-        printf("[DEBUG] Mutex queue status after insert: queue_size=%d, queue_capacity=%d, mutex=%p, waiting_queue ptr=%p\n",
-               mutex->queue_size, mutex->queue_capacity, (void*)mutex, (void*)mutex->waiting_queue);
-        for (int dbg_i = 0; dbg_i < mutex->queue_size; dbg_i++) {
-            printf("[DEBUG] waiting_queue[%d] = PID %d (ptr: %p)\n", dbg_i, mutex->waiting_queue[dbg_i]->pid, (void*)mutex->waiting_queue[dbg_i]);
-        }
+        printf("[DEBUG] Mutex queue status after insert: queue_size=%d, bucket bitmap=0x%x, head=PID %d\n",
+               mutex->queue_size, mutex->wait_bitmap, first_waiter(mutex) ? first_waiter(mutex)->pid : -1);
         snprintf(log_msg, sizeof(log_msg),
             "[Event] [Program: %s | PID %d] Blocked on [%s] (queue size: %d)",
             pcb->program_name, pcb->pid,
             get_resource_name(resource), mutex->queue_size);
         log_event(logger, log_msg);
+        if (!already_waiting) {
+            propagate_to_holders(manager, mutex, 0);
+            check_deadlock(manager, pcb, logger);
+        }
         return false;
     }
 }
 
-PCB* sem_signal(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
-    if (!manager || !pcb || resource >= NUM_RESOURCES) return NULL;
+static PCB* sem_signal_locked(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
+    if (!manager || !pcb || resource < 0 || resource >= manager->count) return NULL;
     Mutex* mutex = &manager->mutexes[resource];
 
-    if (mutex->locked && mutex->owner_pid == pcb->pid) {
+    if (remove_holder(mutex, pcb)) {
         PCB* unblocked_pcb = NULL;
         char log_msg[256];
 
@@ -112,33 +345,25 @@ PCB* sem_signal(ResourceManager* manager, ResourceType resource, PCB* pcb, Logge
         log_event(logger, log_msg);
 
         if (mutex->queue_size > 0) {
-            unblocked_pcb = mutex->waiting_queue[0];
-            for (int i = 0; i < mutex->queue_size - 1; i++) {
-                mutex->waiting_queue[i] = mutex->waiting_queue[i + 1];
-            }
-            mutex->queue_size--;
-            mutex->owner_pid = unblocked_pcb->pid;
+            unblocked_pcb = first_waiter(mutex);
+            remove_waiter(mutex, unblocked_pcb);
+            // The released unit goes straight to the waiter; its retried semWait consumes the grant
+            add_holder(mutex, unblocked_pcb);
+            unblocked_pcb->waiting_on = -1;
+            forget_deadlock(unblocked_pcb);
+            unblocked_pcb->granted_resource = resource;
             set_pcb_state(unblocked_pcb, READY);
 
             if (scheduler != NULL) {
                 // ✅ Remove from blocked queue if present
-                for (int i = 0; i < scheduler->blocked_queue.size; i++) {
-                    if (scheduler->blocked_queue.processes[i] == unblocked_pcb) {
-                        remove_from_queue(&scheduler->blocked_queue, i);
-                        printf("[DEBUG] Removed PID=%d from blocked queue after unblocking.\n", unblocked_pcb->pid);
-                        break;
-                    }
+                scheduler_lock();
+                if (remove_from_blocked_queue(scheduler, unblocked_pcb)) {
+                    printf("[DEBUG] Removed PID=%d from blocked queue after unblocking.\n", unblocked_pcb->pid);
                 }
+                scheduler_unlock();
 
                 // ✅ Check if it's already in ready queue to prevent duplication
-                bool already_ready = false;
-                ProcessQueue* queue = &scheduler->ready_queues[unblocked_pcb->priority - 1];
-                for (int j = 0; j < queue->size; j++) {
-                    if (queue->processes[j] == unblocked_pcb) {
-                        already_ready = true;
-                        break;
-                    }
-                }
+                bool already_ready = is_in_ready_queue(scheduler, unblocked_pcb);
 
                 if (!already_ready) {
                     add_process(scheduler, unblocked_pcb);
@@ -161,22 +386,347 @@ PCB* sem_signal(ResourceManager* manager, ResourceType resource, PCB* pcb, Logge
             printf("[DEBUG] sem_signal unblocked PID=%d on resource %s\n",
                 unblocked_pcb ? unblocked_pcb->pid : -1,
                 get_resource_name(resource));
-        } else {
-            mutex->locked = 0;
-            mutex->owner_pid = -1;
         }
+        // The releaser drops what it inherited through this semaphore; the new holder picks it up
+        propagate_priority(manager, pcb, 0);
+        if (unblocked_pcb) propagate_priority(manager, unblocked_pcb, 0);
         return unblocked_pcb;
     } else {
-        printf("[DEBUG] sem_signal: No action taken (PID=%d does not own %s or resource is unlocked)\n",
+        printf("[DEBUG] sem_signal: No action taken (PID=%d holds no unit of %s)\n",
             pcb->pid, get_resource_name(resource));
     }
     return NULL;
 }
+// ---------------------------------------------------------------------------
+// Priority inheritance.
+// A holder runs at the best priority of any process waiting on a semaphore it
+// holds. When its effective priority changes and it is itself waiting, the
+// change is passed on to the holders of that semaphore, so chains of holders
+// are boosted and restored together.
+// ---------------------------------------------------------------------------
+
+#define MAX_INHERITANCE_DEPTH 64
+
+// Best (numerically lowest) priority among processes waiting on semaphores pcb holds, 0 if none
+static int donated_priority(ResourceManager* manager, const PCB* pcb) {
+    int best = 0;
+    for (int id = 0; id < manager->count; id++) {
+        Mutex* mutex = &manager->mutexes[id];
+        if (mutex->queue_size == 0 || !is_holder(mutex, pcb)) continue;
+        int head = pcb_priority(first_waiter(mutex));
+        if (best == 0 || head < best) best = head;
+    }
+    return best;
+}
+
+static void propagate_priority(ResourceManager* manager, PCB* pcb, int depth) {
+    if (!pcb || depth > MAX_INHERITANCE_DEPTH) return;
+
+    int old_priority = pcb_priority(pcb);
+    set_pcb_inherited_priority(pcb, manager->priority_inheritance ? donated_priority(manager, pcb) : 0);
+    int priority = pcb_priority(pcb);
+    if (priority == old_priority) return;
+
+    char log_msg[MAX_PROGRAM_NAME_LENGTH + 128];
+    if (priority < old_priority) {
+        // Its own CPU may demote it meanwhile
+        int base_priority = __atomic_load_n(&pcb->base_priority, __ATOMIC_RELAXED);
+        snprintf(log_msg, sizeof(log_msg),
+            "[Event] [Program: %s | PID %d] Inherited priority %d (own priority %d)",
+            pcb->program_name, pcb->pid, priority, base_priority);
+        if (scheduler != NULL) {
+            scheduler_lock();
+            scheduler->metrics.inheritance_boosts++;
+            scheduler_unlock();
+        }
+    } else {
+        snprintf(log_msg, sizeof(log_msg),
+            "[Event] [Program: %s | PID %d] Priority restored to %d",
+            pcb->program_name, pcb->pid, priority);
+    }
+    log_event(&logger, log_msg);
+
+    if (scheduler != NULL) reposition_process(scheduler, pcb);
+
+    // Pass the change along the chain: re-sort it among its fellow waiters, then update their holders
+    if (pcb->waiting_on >= 0) {
+        Mutex* next = &manager->mutexes[pcb->waiting_on];
+        if (remove_waiter(next, pcb)) insert_waiter(next, pcb);
+        propagate_to_holders(manager, next, depth + 1);
+    }
+}
+
+// Number of waiters currently blocked behind a holder whose own priority is lower than theirs
+int count_priority_inversions(ResourceManager* manager) {
+    if (!manager || !manager->mutexes) return 0;
+    pthread_mutex_lock(&resource_lock);
+    // Cleared before counting, so a change made meanwhile is picked up next time
+    if (!__atomic_exchange_n(&inversions_stale, 0, __ATOMIC_RELAXED)) {
+        int inverted = cached_inversions;
+        pthread_mutex_unlock(&resource_lock);
+        return inverted;
+    }
+    int inverted = 0;
+    for (int id = 0; id < manager->count; id++) {
+        Mutex* mutex = &manager->mutexes[id];
+        if (mutex->queue_size == 0) continue;
+        // Only the holder with the lowest own priority matters
+        int worst_holder = 0;
+        for (int h = 0; h < mutex->holder_count; h++) {
+            if (mutex->holders[h]->base_priority > worst_holder) worst_holder = mutex->holders[h]->base_priority;
+        }
+        for (int level = 0; level < WAIT_LEVELS; level++) {
+            for (PCB* waiter = mutex->wait_head[level]; waiter; waiter = waiter->wait_next) {
+                if (worst_holder > pcb_priority(waiter)) inverted++;
+            }
+        }
+    }
+    cached_inversions = inverted;
+    pthread_mutex_unlock(&resource_lock);
+    return inverted;
+}
+
+// ---------------------------------------------------------------------------
+// Deadlock detection over the wait-for graph.
+// A blocked process has an edge to every holder of the semaphore it waits on;
+// sem_acquire/sem_signal keep waiting_on and the holder lists current, so the
+// graph is never rebuilt. The graph has no deadlock before a new wait (each
+// earlier wait was checked), so only processes reachable from the new waiter
+// need to be searched. A waiter can still be woken if any reachable process is
+// able to run and release a unit, so it is deadlocked only if none is.
+// Under DEADLOCK_REPORT_ONLY a reported deadlock stays in the graph, so its
+// members carry the current deadlock generation and later waiters that join
+// it are not reported again; any member leaving its wait starts a new one.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    PCB** items;
+    int size;
+    int capacity;
+} PcbList;
+
+static PcbList wfg_stack;
+static PcbList wfg_members;
+static unsigned wfg_epoch = 0;
+static unsigned deadlock_generation = 1;
+static char last_deadlock_report[1024] = "";
+
+static void pcb_list_push(PcbList* list, PCB* pcb) {
+    if (list->size >= list->capacity) {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        PCB** items = realloc(list->items, list->capacity * sizeof(PCB*));
+        if (!items) {
+            fprintf(stderr, "Failed to realloc wait-for graph list!\n");
+            exit(EXIT_FAILURE);
+        }
+        list->items = items;
+    }
+    list->items[list->size++] = pcb;
+}
+
+// Fills wfg_members with everything reachable from start; true if none of it can make progress
+static bool find_deadlock(ResourceManager* manager, PCB* start) {
+    wfg_stack.size = 0;
+    wfg_members.size = 0;
+    if (++wfg_epoch == 0) wfg_epoch = 1;
+
+    start->wfg_mark = wfg_epoch;
+    pcb_list_push(&wfg_stack, start);
+    while (wfg_stack.size > 0) {
+        PCB* pcb = wfg_stack.items[--wfg_stack.size];
+        pcb_list_push(&wfg_members, pcb);
+        // A holder may be running on another CPU, which sets its state as it goes
+        if (__atomic_load_n(&pcb->state, __ATOMIC_RELAXED) != BLOCKED || pcb->waiting_on < 0) return false;
+
+        Mutex* mutex = &manager->mutexes[pcb->waiting_on];
+        if (mutex->available > 0) return false;
+        for (int i = 0; i < mutex->holder_count; i++) {
+            PCB* holder = mutex->holders[i];
+            if (holder->wfg_mark == wfg_epoch) continue;
+            holder->wfg_mark = wfg_epoch;
+            pcb_list_push(&wfg_stack, holder);
+        }
+    }
+    return true;
+}
+
+// Called when pcb stops waiting; a deadlock it was reported in may be broken now
+static void forget_deadlock(PCB* pcb) {
+    if (pcb->deadlock_mark != deadlock_generation) return;
+    if (++deadlock_generation == 0) deadlock_generation = 1;
+}
+
+// True if the members found by find_deadlock belong to an already reported deadlock; marks them all
+static bool deadlock_already_reported() {
+    bool reported = false;
+    for (int m = 0; m < wfg_members.size; m++) {
+        if (wfg_members.items[m]->deadlock_mark == deadlock_generation) reported = true;
+        wfg_members.items[m]->deadlock_mark = deadlock_generation;
+    }
+    return reported;
+}
+
+static void build_deadlock_report(ResourceManager* manager) {
+    int used = snprintf(last_deadlock_report, sizeof(last_deadlock_report), "Deadlock among %d process(es):",
+        wfg_members.size);
+    for (int m = 0; m < wfg_members.size && used < (int)sizeof(last_deadlock_report); m++) {
+        PCB* pcb = wfg_members.items[m];
+        Mutex* mutex = &manager->mutexes[pcb->waiting_on];
+        used += snprintf(last_deadlock_report + used, sizeof(last_deadlock_report) - used,
+            " PID %d waits for [%s] held by", pcb->pid, get_resource_name(pcb->waiting_on));
+        for (int h = 0; h < mutex->holder_count && used < (int)sizeof(last_deadlock_report); h++) {
+            used += snprintf(last_deadlock_report + used, sizeof(last_deadlock_report) - used,
+                " PID %d", mutex->holders[h]->pid);
+        }
+        if (used < (int)sizeof(last_deadlock_report)) {
+            used += snprintf(last_deadlock_report + used, sizeof(last_deadlock_report) - used, ";");
+        }
+    }
+}
+
+// The latest arrival loses the least work; PID breaks ties
+static PCB* choose_deadlock_victim() {
+    PCB* victim = NULL;
+    for (int m = 0; m < wfg_members.size; m++) {
+        PCB* pcb = wfg_members.items[m];
+        if (!victim || pcb->arrival_time > victim->arrival_time ||
+            (pcb->arrival_time == victim->arrival_time && pcb->pid > victim->pid)) {
+            victim = pcb;
+        }
+    }
+    return victim;
+}
+
+// Take the victim out of its semaphore's wait list and the scheduler's blocked queue
+static void cancel_wait(ResourceManager* manager, PCB* pcb) {
+    if (pcb->waiting_on >= 0) {
+        Mutex* mutex = &manager->mutexes[pcb->waiting_on];
+        remove_waiter(mutex, pcb);
+        pcb->waiting_on = -1;
+        forget_deadlock(pcb);
+        propagate_to_holders(manager, mutex, 0);
+    }
+    if (scheduler != NULL) {
+        scheduler_lock();
+        remove_from_blocked_queue(scheduler, pcb);
+        scheduler_unlock();
+    }
+}
+
+// Earliest instruction before the PC that acquired a semaphore the process still holds
+static int rollback_point(ResourceManager* manager, PCB* pcb) {
+    int target = pcb->program_counter;
+    if (!pcb->resource_ids) return target;
+    for (int id = 0; id < manager->count; id++) {
+        if (!is_holder(&manager->mutexes[id], pcb)) continue;
+        for (int i = pcb->program_counter - 1; i >= 0; i--) {
+            if (pcb->resource_ids[i] == id && parse_instruction(pcb->instructions[i]) == INSTR_SEM_WAIT) {
+                if (i < target) target = i;
+                break;
+            }
+        }
+    }
+    return target;
+}
+
+// Release every unit the victim holds; each one goes to the next waiter as a normal signal would
+static void release_all_units(ResourceManager* manager, PCB* pcb, Logger* logger) {
+    for (int id = 0; id < manager->count; id++) {
+        while (is_holder(&manager->mutexes[id], pcb)) {
+            sem_signal_locked(manager, id, pcb, logger);
+        }
+    }
+}
+
+static void check_deadlock(ResourceManager* manager, PCB* waiter, Logger* logger) {
+    if (!find_deadlock(manager, waiter)) return;
+    if (manager->deadlock_policy == DEADLOCK_REPORT_ONLY && deadlock_already_reported()) return;
+
+    build_deadlock_report(manager);
+    char log_msg[1200];
+    snprintf(log_msg, sizeof(log_msg), "[DEADLOCK] %s", last_deadlock_report);
+    log_event(logger, log_msg);
+    printf("[WARN] %s\n", last_deadlock_report);
+    if (scheduler != NULL) {
+        scheduler_lock();
+        scheduler->metrics.deadlocks++;
+        scheduler_unlock();
+    }
+
+    if (manager->deadlock_policy == DEADLOCK_REPORT_ONLY) return;
+
+    PCB* victim = choose_deadlock_victim();
+    cancel_wait(manager, victim);
+    victim->granted_resource = -1;
+
+    if (manager->deadlock_policy == DEADLOCK_ABORT_YOUNGEST) {
+        set_pcb_state(victim, TERMINATED);
+        release_all_units(manager, victim, logger);
+        snprintf(log_msg, sizeof(log_msg),
+            "[DEADLOCK] [Program: %s | PID %d] Aborted to break the deadlock.",
+            victim->program_name, victim->pid);
+    } else {
+        int rollback = rollback_point(manager, victim);
+        release_all_units(manager, victim, logger);
+        snprintf(log_msg, sizeof(log_msg),
+            "[DEADLOCK] [Program: %s | PID %d] Resources preempted; rolled back from instruction %d to %d.",
+            victim->program_name, victim->pid, victim->program_counter, rollback);
+        victim->program_counter = rollback;
+        set_pcb_state(victim, READY);
+        if (scheduler != NULL) add_process(scheduler, victim);
+    }
+    log_event(logger, log_msg);
+    if (scheduler != NULL) {
+        scheduler_lock();
+        scheduler->metrics.deadlock_recoveries++;
+        scheduler_unlock();
+    }
+}
+
+const char* get_last_deadlock_report() {
+    return last_deadlock_report;
+}
+
+bool sem_acquire(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
+    pthread_mutex_lock(&resource_lock);
+    bool acquired = sem_wait_locked(manager, resource, pcb, logger);
+    pthread_mutex_unlock(&resource_lock);
+    return acquired;
+}
+
+PCB* sem_signal(ResourceManager* manager, ResourceType resource, PCB* pcb, Logger* logger) {
+    pthread_mutex_lock(&resource_lock);
+    PCB* unblocked = sem_signal_locked(manager, resource, pcb, logger);
+    pthread_mutex_unlock(&resource_lock);
+    return unblocked;
+}
+
+// Withdraw pcb from the semaphore it is waiting on (semWait timeout). False if it is
+// no longer waiting, e.g. sem_signal handed it a unit first; the caller then leaves it be.
+bool sem_cancel_wait(ResourceManager* manager, PCB* pcb) {
+    if (!manager || !pcb) return false;
+    pthread_mutex_lock(&resource_lock);
+    bool waiting = pcb->waiting_on >= 0 && pcb->waiting_on < manager->count && pcb->wait_level >= 0;
+    if (waiting) {
+        Mutex* mutex = &manager->mutexes[pcb->waiting_on];
+        remove_waiter(mutex, pcb);
+        pcb->waiting_on = -1;
+        forget_deadlock(pcb);
+        propagate_to_holders(manager, mutex, 0);
+    }
+    pthread_mutex_unlock(&resource_lock);
+    return waiting;
+}
+
 const char* get_resource_name(ResourceType resource) {
     switch (resource) {
         case RESOURCE_USER_INPUT: return "User Input";
         case RESOURCE_USER_OUTPUT: return "User Output";
         case RESOURCE_FILE: return "File";
-        default: return "Unknown";
+        default:
+            if (resource >= 0 && resource < resource_manager.count) {
+                return resource_manager.mutexes[resource].name;
+            }
+            return "Unknown";
     }
-}
\ No newline at end of file
+}
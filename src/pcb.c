@@ -6,7 +6,10 @@
 #include "interpreter.h"
 #include "memory.h"
 #include "mutex.h"
+#include "program.h"
 #include "queue.h" 
+#include "cfs.h"
+#include "events.h"
 
 // Create a new PCB
 PCB* create_pcb(int pid, int arrival_time) {
@@ -16,17 +19,48 @@ PCB* create_pcb(int pid, int arrival_time) {
     pcb->pid = pid;
     pcb->state = NEW;
     pcb->priority = 1;
+    pcb->base_priority = 1;
+    pcb->inherited_priority = 0;
     pcb->program_counter = 0;
     pcb->memory_lower_bound = -1;
     pcb->memory_upper_bound = -1;
+    pcb->text_base = -1;
     pcb->arrival_time = arrival_time;
     pcb->quantum_remaining = 0;
-    pcb->time_in_queue = 0;
+    pcb->queued_at = 0;
+    pcb->ready_since = 0;
+    pcb->starving = 0;
+    pcb->blocked_index = -1;
     pcb->var_count = 0;
     pcb->variables = NULL;
     pcb->values = NULL;
     pcb->instruction_count = 0;
     pcb->instructions = NULL;
+    pcb->affinity_mask = 0;
+    pcb->last_cpu = -1;
+    pcb->queued_cpu = -1;
+    pcb->program = NULL;
+    pcb->resource_ids = NULL;
+    pcb->waiting_on = -1;
+    pcb->granted_resource = -1;
+    pcb->io_wait = 0;
+    pcb->device_wait = -1;
+    pcb->wake_cycle = 0;
+    pcb->stall_cycles = 0;
+    timer_init(&pcb->timer, pcb);
+    pcb->wfg_mark = 0;
+    pcb->deadlock_mark = 0;
+    pcb->wait_level = -1;
+    pcb->wait_prev = NULL;
+    pcb->wait_next = NULL;
+    pcb->vruntime = 0;
+    pcb->nice = 0;
+    pcb->weight = cfs_weight_for_nice(0);
+    pcb->on_rq = 0;
+    pcb->rb_color = 0;
+    pcb->rb_left = NULL;
+    pcb->rb_right = NULL;
+    pcb->rb_parent = NULL;
 
     return pcb;
 }
@@ -35,6 +69,7 @@ PCB* create_pcb(int pid, int arrival_time) {
 void destroy_pcb(PCB* pcb) {
     if (!pcb) return;
 
+    timer_cancel(&pcb->timer);
     for (int i = 0; i < pcb->var_count; i++) {
         free(pcb->variables[i]);
         free(pcb->values[i]);
@@ -42,10 +77,15 @@ void destroy_pcb(PCB* pcb) {
     free(pcb->variables);
     free(pcb->values);
 
-    for (int i = 0; i < pcb->instruction_count; i++) {
-        free(pcb->instructions[i]);
+    if (pcb->program) {
+        program_release(pcb->program);
+    } else {
+        for (int i = 0; i < pcb->instruction_count; i++) {
+            free(pcb->instructions[i]);
+        }
+        free(pcb->instructions);
     }
-    free(pcb->instructions);
+    free(pcb->resource_ids);
 
     // Confirmed all allocated memory is freed properly.
 
@@ -55,23 +95,76 @@ void destroy_pcb(PCB* pcb) {
 // Set state
 void set_pcb_state(PCB* pcb, ProcessState state) {
     if (pcb) {
-        printf("[DEBUG] set_pcb_state: PID=%d, Changing state from %s to %s\n",
-               pcb->pid,
-               get_state_string(pcb->state),
-               get_state_string(state));
-        pcb->state = state;
+        if (!scheduler || scheduler->verbose) {
+            printf("[DEBUG] set_pcb_state: PID=%d, Changing state from %s to %s\n",
+                   pcb->pid,
+                   get_state_string(pcb->state),
+                   get_state_string(state));
+        }
+        ProcessState previous = pcb->state;
+        // The deadlock check reads other CPUs' processes' states
+        __atomic_store_n(&pcb->state, state, __ATOMIC_RELAXED);
+        if (pcb->text_base >= 0) update_pcb_state_in_memory(pcb);
+        if (previous != state) event_emit(EVENT_STATE, pcb->pid, state, previous);
     } else {
         printf("[DEBUG] set_pcb_state: NULL pcb pointer received!\n");
     }
 }
 
+// Priority inheritance changes a process from whichever CPU's thread signals or waits,
+// possibly while its own CPU runs or queues it, so the three priorities go through atomics
+int pcb_priority(const PCB* pcb) {
+    return __atomic_load_n(&pcb->priority, __ATOMIC_RELAXED);
+}
+
 // Set priority
+static void refresh_effective_priority(PCB* pcb) {
+    int previous = pcb_priority(pcb);
+    int priority = __atomic_load_n(&pcb->base_priority, __ATOMIC_RELAXED);
+    int inherited = __atomic_load_n(&pcb->inherited_priority, __ATOMIC_RELAXED);
+    if (inherited > 0 && inherited < priority) priority = inherited;
+    __atomic_store_n(&pcb->priority, priority, __ATOMIC_RELAXED);
+    if (priority != previous) invalidate_priority_inversions();
+}
+
+// Sets the process's own priority; an inherited boost still applies on top
 void set_pcb_priority(PCB* pcb, int priority) {
     if (pcb && priority >= 1 && priority <= 4) {
-        pcb->priority = priority;
+        // Inversions compare waiters against their holders' own priority
+        if (pcb->base_priority != priority) invalidate_priority_inversions();
+        __atomic_store_n(&pcb->base_priority, priority, __ATOMIC_RELAXED);
+        refresh_effective_priority(pcb);
+    }
+}
+
+// Priority donated by waiters on resources it holds (0 clears the boost)
+void set_pcb_inherited_priority(PCB* pcb, int priority) {
+    if (pcb && priority >= 0 && priority <= 4) {
+        __atomic_store_n(&pcb->inherited_priority, priority, __ATOMIC_RELAXED);
+        refresh_effective_priority(pcb);
+    }
+}
+
+// Set nice value (CFS weight follows it)
+void set_pcb_nice(PCB* pcb, int nice) {
+    if (pcb && nice >= CFS_MIN_NICE && nice <= CFS_MAX_NICE) {
+        pcb->nice = nice;
+        pcb->weight = cfs_weight_for_nice(nice);
+    }
+}
+
+// Restrict the process to a set of CPUs (0 = run anywhere)
+void set_pcb_affinity(PCB* pcb, uint64_t mask) {
+    if (pcb) {
+        pcb->affinity_mask = mask;
     }
 }
 
+bool pcb_can_run_on(const PCB* pcb, int cpu_id) {
+    if (!pcb || cpu_id < 0 || cpu_id >= 64) return false;
+    return pcb->affinity_mask == 0 || (pcb->affinity_mask & ((uint64_t)1 << cpu_id)) != 0;
+}
+
 // Set memory bounds
 void set_pcb_memory_bounds(PCB* pcb, int lower, int upper) {
     if (pcb && lower >= 0 && upper >= lower) {
@@ -96,7 +189,16 @@ void add_pcb_instruction(PCB* pcb, const char* instruction) {
     pcb->instruction_count++;
 }
 
-// Update variable or create new if not exist
+// Memory word of variable index, -1 if it falls outside the process's block.
+// With a shared text segment the block holds the PCB words and then the variables;
+// processes restored from older checkpoints still keep their instructions in front.
+int pcb_variable_address(const PCB* pcb, int index) {
+    if (!pcb || pcb->memory_lower_bound < 0) return -1;
+    int offset = pcb->text_base < 0 && pcb->instruction_count > 0 ? pcb->instruction_count : PCB_MEMORY_WORDS;
+    int address = pcb->memory_lower_bound + offset + index;
+    return address <= pcb->memory_upper_bound ? address : -1;
+}
+
 // Update variable or create new if not exist
 void update_pcb_variable(PCB* pcb, const char* name, const char* value) {
     if (!pcb || !name || !value) return;
@@ -106,8 +208,8 @@ void update_pcb_variable(PCB* pcb, const char* name, const char* value) {
             free(pcb->values[i]);
             pcb->values[i] = strdup(value);
 
-            int mem_addr = pcb->memory_lower_bound + pcb->instruction_count + i;  
-            write_memory(&memory, mem_addr, name, value, pcb->pid);
+            int mem_addr = pcb_variable_address(pcb, i);
+            if (mem_addr >= 0) write_memory(&memory, mem_addr, name, value, pcb->pid);
             return;
         }
     }
@@ -128,8 +230,8 @@ void update_pcb_variable(PCB* pcb, const char* name, const char* value) {
         return;
     }
 
-    int mem_addr = pcb->memory_lower_bound + pcb->instruction_count + pcb->var_count;
-    write_memory(&memory, mem_addr, name, value, pcb->pid);
+    int mem_addr = pcb_variable_address(pcb, pcb->var_count);
+    if (mem_addr >= 0) write_memory(&memory, mem_addr, name, value, pcb->pid);
 
     pcb->var_count++;
 }
@@ -0,0 +1,389 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "program.h"
+#include "interpreter.h"
+
+#ifdef _WIN32
+#define stat_path _stat64
+typedef struct _stat64 path_stat_t;
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#define stat_path stat
+typedef struct stat path_stat_t;
+#endif
+
+#define INITIAL_PROGRAM_TABLE_SIZE 16   // power of two, kept at most half full
+#define INITIAL_LINE_CAPACITY 16
+
+// Loads come from the API thread, releases from whoever destroys the PCB
+static pthread_mutex_t program_lock = PTHREAD_MUTEX_INITIALIZER;
+static Program** program_table = NULL;   // open addressing on path, NULL = empty
+static int program_table_size = 0;
+static int program_count = 0;
+static ProgramCacheStats stats;
+
+// FNV-1a
+static uint32_t hash_path(const char* path) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int program_slot(const char* path) {
+    int mask = program_table_size - 1;
+    int slot = (int)(hash_path(path) & (uint32_t)mask);
+    while (program_table[slot] && strcmp(program_table[slot]->path, path) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void grow_program_table() {
+    int old_size = program_table_size;
+    Program** old_table = program_table;
+    program_table_size = old_size ? old_size * 2 : INITIAL_PROGRAM_TABLE_SIZE;
+    program_table = calloc(program_table_size, sizeof(Program*));
+    if (!program_table) {
+        fprintf(stderr, "Failed to grow program cache!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < old_size; i++) {
+        if (old_table[i]) program_table[program_slot(old_table[i]->path)] = old_table[i];
+    }
+    free(old_table);
+}
+
+static void free_program(Program* program) {
+    for (int i = 0; program->variable_names && i < program->variable_count; i++) {
+        free(program->variable_names[i]);
+    }
+    free(program->variable_names);
+    free(program->decoded);
+    for (int i = 0; program->resource_names && i < program->instruction_count; i++) {
+        free(program->resource_names[i]);
+    }
+    for (int i = 0; program->resolved_lines && i < program->instruction_count; i++) {
+        free(program->resolved_lines[i]);
+    }
+    free(program->resource_names);
+    free(program->resolved_lines);
+    free(program->instructions);
+    free(program->declarations);
+    free(program->text);
+    free(program->path);
+    free(program);
+}
+
+// Whole file in one heap block with a terminating NUL, read in one pass rather than line by line
+static char* load_text(const char* path, time_t* mtime, long long* size) {
+#ifdef _WIN32
+    path_stat_t st;
+    if (stat_path(path, &st) != 0) return NULL;
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    char* text = malloc((size_t)st.st_size + 1);
+    if (text && fread(text, 1, (size_t)st.st_size, file) != (size_t)st.st_size) {
+        free(text);
+        text = NULL;
+    }
+    fclose(file);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    path_stat_t st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    // Read straight into the buffer the program keeps; read() may return short
+    char* text = malloc((size_t)st.st_size + 1);
+    size_t done = 0;
+    while (text && done < (size_t)st.st_size) {
+        ssize_t got = read(fd, text + done, (size_t)st.st_size - done);
+        if (got <= 0) {
+            free(text);
+            text = NULL;
+        } else {
+            done += (size_t)got;
+        }
+    }
+    close(fd);
+#endif
+    if (!text) return NULL;
+    text[st.st_size] = '\0';
+    *mtime = st.st_mtime;
+    *size = (long long)st.st_size;
+    return text;
+}
+
+static void append_line(char*** lines, int* count, int* capacity, char* line) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : INITIAL_LINE_CAPACITY;
+        char** grown = realloc(*lines, *capacity * sizeof(char*));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow program!\n");
+            exit(EXIT_FAILURE);
+        }
+        *lines = grown;
+    }
+    (*lines)[(*count)++] = line;
+}
+
+// A "name:" line marks the next instruction as a branch target
+typedef struct {
+    char** names;
+    int* targets;
+    int count;
+    int capacity;
+} LabelTable;
+
+static void add_label(LabelTable* labels, char* name, int target) {
+    if (labels->count == labels->capacity) {
+        labels->capacity = labels->capacity ? labels->capacity * 2 : INITIAL_LINE_CAPACITY;
+        char** names = realloc(labels->names, labels->capacity * sizeof(char*));
+        int* targets = realloc(labels->targets, labels->capacity * sizeof(int));
+        if (!names || !targets) {
+            fprintf(stderr, "Failed to grow label table!\n");
+            exit(EXIT_FAILURE);
+        }
+        labels->names = names;
+        labels->targets = targets;
+    }
+    labels->names[labels->count] = name;
+    labels->targets[labels->count++] = target;
+}
+
+static int find_label(const LabelTable* labels, const char* name) {
+    for (int i = 0; i < labels->count; i++) {
+        if (strcmp(labels->names[i], name) == 0) return labels->targets[i];
+    }
+    return -1;
+}
+
+// Rewrite a branch's label operand as an instruction index; false if the target is unknown
+static bool resolve_branch(Program* program, int index, const LabelTable* labels) {
+    const char* line = program->instructions[index];
+    int target_token = branch_target_token(parse_instruction(line));
+    if (target_token < 0) return true;
+
+    char tokens[3][MAX_RESOURCE_NAME] = {"", "", ""};
+    int count = sscanf(line, "%63s %63s %63s", tokens[0], tokens[1], tokens[2]);
+    if (count != target_token + 1) return true;   // malformed; reported when it runs
+    const char* operand = tokens[target_token];
+    char* end;
+    long target = strtol(operand, &end, 10);
+    if (end == operand || *end != '\0') {
+        target = find_label(labels, operand);
+        if (target < 0) {
+            printf("[ERROR] %s: undefined label '%s' in [%s]\n", program->path, operand, line);
+            return false;
+        }
+    } else if (target < 0 || target > program->instruction_count) {
+        printf("[ERROR] %s: branch target %ld out of range in [%s]\n", program->path, target, line);
+        return false;
+    }
+
+    char resolved[3 * MAX_RESOURCE_NAME + 16];
+    if (target_token == 1) snprintf(resolved, sizeof(resolved), "%s %ld", tokens[0], target);
+    else snprintf(resolved, sizeof(resolved), "%s %s %ld", tokens[0], tokens[1], target);
+    program->resolved_lines[index] = strdup(resolved);
+    program->instructions[index] = program->resolved_lines[index];
+    return true;
+}
+
+static int find_variable(const Program* program, const char* name) {
+    for (int v = 0; v < program->variable_count; v++) {
+        if (strcmp(program->variable_names[v], name) == 0) return v;
+    }
+    return -1;
+}
+
+// A variable the program writes, or an integer literal; false for anything else
+static bool decode_operand(const Program* program, const char* token, Operand* operand) {
+    operand->slot = find_variable(program, token);
+    operand->literal = 0;
+    if (operand->slot >= 0) return true;
+    // Only literals that print back unchanged, so a fast assign stores exactly the token
+    char* end;
+    operand->literal = strtoll(token, &end, 10);
+    char canonical[32];
+    snprintf(canonical, sizeof(canonical), "%lld", operand->literal);
+    return end != token && *end == '\0' && strcmp(canonical, token) == 0;
+}
+
+// Tokenized the way execute_instruction_core does it, so both paths agree on what a line means
+static DecodedInstruction decode_instruction(const Program* program, const char* line) {
+    DecodedInstruction decoded = {OP_SLOW, -1, {-1, 0}, {-1, 0}, -1};
+    char copy[4 * MAX_RESOURCE_NAME];
+    if (strlen(line) >= sizeof(copy)) return decoded;
+    strcpy(copy, line);
+    char* tokens[5] = {NULL, NULL, NULL, NULL, NULL};
+    int count = 0;
+    for (char* token = strtok(copy, " "); token && count < 5; token = strtok(NULL, " ")) {
+        tokens[count++] = token;
+    }
+
+    InstructionType type = parse_instruction(line);
+    DecodedInstruction fast = decoded;
+    bool ok = false;
+    if (type == INSTR_ASSIGN) {
+        fast.opcode = OP_ASSIGN;
+        ok = count == 3 && strcmp(tokens[2], "input") != 0
+            && decode_operand(program, tokens[2], &fast.a);
+    } else if (type >= INSTR_ADD && type <= INSTR_GE) {
+        fast.opcode = OP_ADD + (type - INSTR_ADD);
+        ok = count == 4 && decode_operand(program, tokens[2], &fast.a)
+            && decode_operand(program, tokens[3], &fast.b);
+    } else if (type == INSTR_JMP) {
+        fast.opcode = OP_JMP;
+        ok = count == 2;
+        if (ok) fast.target = atoi(tokens[1]);
+    } else if (type == INSTR_JZ || type == INSTR_JNZ) {
+        fast.opcode = type == INSTR_JZ ? OP_JZ : OP_JNZ;
+        ok = count == 3 && decode_operand(program, tokens[1], &fast.a);
+        if (ok) fast.target = atoi(tokens[2]);
+    }
+    if (ok && instruction_writes_variable(type)) {
+        fast.dest = find_variable(program, tokens[1]);
+        ok = fast.dest >= 0;
+    }
+    return ok ? fast : decoded;
+}
+
+// One pass over the text: lines are terminated in place and sorted into instructions and declarations
+static Program* parse_program(const char* path) {
+    Program* program = calloc(1, sizeof(Program));
+    if (!program) return NULL;
+    program->text = load_text(path, &program->mtime, &program->size);
+    if (!program->text) {
+        free(program);
+        return NULL;
+    }
+    program->path = strdup(path);
+
+    int instruction_capacity = 0, declaration_capacity = 0;
+    LabelTable labels = {NULL, NULL, 0, 0};
+    char* end = program->text + program->size;
+    for (char* line = program->text; line < end; ) {
+        char* newline = memchr(line, '\n', end - line);
+        char* next = newline ? newline + 1 : end;
+        char* stop = newline ? newline : end;
+        if (stop > line && stop[-1] == '\r') stop--;
+        *stop = '\0';
+        if (stop > line + 1 && stop[-1] == ':' && !strpbrk(line, " \t")) {
+            stop[-1] = '\0';
+            add_label(&labels, line, program->instruction_count);
+        } else if (stop > line) {
+            if (parse_instruction(line) == INSTR_SEM_INIT) {
+                append_line(&program->declarations, &program->declaration_count, &declaration_capacity, line);
+            } else {
+                append_line(&program->instructions, &program->instruction_count, &instruction_capacity, line);
+            }
+        }
+        line = next;
+    }
+
+    int slots = program->instruction_count ? program->instruction_count : 1;
+    program->resource_names = calloc(slots, sizeof(char*));
+    program->resolved_lines = calloc(slots, sizeof(char*));
+    bool ok = program->resource_names && program->resolved_lines;
+    // Distinct variables written by the program, i.e. the data words each process needs
+    int variable_capacity = 0;
+    for (int i = 0; ok && i < program->instruction_count; i++) {
+        ok = resolve_branch(program, i, &labels);
+        InstructionType type = parse_instruction(program->instructions[i]);
+        char keyword[16], name[MAX_RESOURCE_NAME];
+        if (!ok || sscanf(program->instructions[i], "%15s %63s", keyword, name) != 2) continue;
+        if (type == INSTR_SEM_WAIT || type == INSTR_SEM_SIGNAL) {
+            program->resource_names[i] = strdup(name);
+        } else if (instruction_writes_variable(type)) {
+            if (find_variable(program, name) < 0) {
+                append_line(&program->variable_names, &program->variable_count, &variable_capacity, strdup(name));
+            }
+        }
+    }
+    program->decoded = ok ? malloc(slots * sizeof(DecodedInstruction)) : NULL;
+    ok = ok && program->decoded;
+    for (int i = 0; ok && i < program->instruction_count; i++) {
+        program->decoded[i] = decode_instruction(program, program->instructions[i]);
+    }
+    free(labels.names);
+    free(labels.targets);
+    if (!ok) {
+        free_program(program);
+        return NULL;
+    }
+    return program;
+}
+
+// The parsed program at path, parsing it only if it is new or changed on disk.
+// The caller owns one reference and hands it back with program_release.
+Program* program_load(const char* path) {
+    if (!path) return NULL;
+    path_stat_t st;
+    if (stat_path(path, &st) != 0) return NULL;
+
+    pthread_mutex_lock(&program_lock);
+    if (!program_table) grow_program_table();
+    int slot = program_slot(path);
+    Program* program = program_table[slot];
+    if (!program || program->mtime != st.st_mtime || program->size != (long long)st.st_size) {
+        Program* parsed = parse_program(path);
+        if (!parsed) {
+            pthread_mutex_unlock(&program_lock);
+            return NULL;
+        }
+        stats.parses++;
+        parsed->refs = 1;   // the cache's own reference
+        if (program) {
+            // Processes already running the old text keep it until they finish
+            if (--program->refs == 0) free_program(program);
+        } else if ((program_count + 1) * 2 > program_table_size) {
+            grow_program_table();
+            slot = program_slot(path);
+        }
+        if (!program) program_count++;
+        program_table[slot] = parsed;
+        program = parsed;
+    }
+    program->refs++;
+    stats.loads++;
+    pthread_mutex_unlock(&program_lock);
+    return program;
+}
+
+void program_release(Program* program) {
+    if (!program) return;
+    pthread_mutex_lock(&program_lock);
+    if (--program->refs == 0) free_program(program);
+    pthread_mutex_unlock(&program_lock);
+}
+
+// Forget every cached program; ones still in use are freed by their last PCB
+void program_cache_clear() {
+    pthread_mutex_lock(&program_lock);
+    for (int i = 0; i < program_table_size; i++) {
+        Program* program = program_table[i];
+        if (program && --program->refs == 0) free_program(program);
+        program_table[i] = NULL;
+    }
+    program_count = 0;
+    pthread_mutex_unlock(&program_lock);
+}
+
+ProgramCacheStats program_cache_stats() {
+    pthread_mutex_lock(&program_lock);
+    ProgramCacheStats copy = stats;
+    copy.cached = program_count;
+    pthread_mutex_unlock(&program_lock);
+    return copy;
+}
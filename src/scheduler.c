@@ -8,10 +8,105 @@
 #include "../include/mutex.h"
 #include "../include/pcb.h"
 #include "../include/queue.h"
+#include "../include/aio.h"
+#include "../include/device.h"
+#include "../include/vfs.h"
+#include "../include/cfs.h"
+#include "../include/smp.h"
+#include "../include/timer.h"
+#include "../include/events.h"
 
 #define INITIAL_QUEUE_CAPACITY 10
 
-PendingList pending_list = {.count = 0};
+PendingList pending_list = {.list = NULL, .count = 0, .capacity = 0};
+
+// Guards the blocked queue and pending list; recursive because sem_signal re-enters add_process
+static pthread_mutex_t sched_mutex;
+static pthread_once_t sched_mutex_once = PTHREAD_ONCE_INIT;
+
+static void init_sched_mutex() {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&sched_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void scheduler_lock() {
+    pthread_once(&sched_mutex_once, init_sched_mutex);
+    pthread_mutex_lock(&sched_mutex);
+}
+
+void scheduler_unlock() {
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+static bool arrives_before(const PCB* a, const PCB* b) {
+    if (a->arrival_time != b->arrival_time) return a->arrival_time < b->arrival_time;
+    return a->pid < b->pid;
+}
+
+// Queue a future arrival
+void add_pending_process(PCB* pcb) {
+    if (!pcb) return;
+    scheduler_lock();
+    if (pending_list.count >= pending_list.capacity) {
+        int capacity = pending_list.capacity > 0 ? pending_list.capacity * 2 : INITIAL_QUEUE_CAPACITY;
+        PCB** list = realloc(pending_list.list, capacity * sizeof(PCB*));
+        if (!list) {
+            scheduler_unlock();
+            printf("[ERROR] Failed to grow pending list; PID %d dropped.\n", pcb->pid);
+            return;
+        }
+        pending_list.list = list;
+        pending_list.capacity = capacity;
+    }
+    int i = pending_list.count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!arrives_before(pcb, pending_list.list[parent])) break;
+        pending_list.list[i] = pending_list.list[parent];
+        i = parent;
+    }
+    pending_list.list[i] = pcb;
+    scheduler_unlock();
+}
+
+PCB* peek_pending_process() {
+    return pending_list.count > 0 ? pending_list.list[0] : NULL;
+}
+
+// Remove and return the earliest arrival
+PCB* pop_pending_process() {
+    scheduler_lock();
+    if (pending_list.count == 0) {
+        scheduler_unlock();
+        return NULL;
+    }
+    PCB* first = pending_list.list[0];
+    PCB* last = pending_list.list[--pending_list.count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= pending_list.count) break;
+        if (child + 1 < pending_list.count && arrives_before(pending_list.list[child + 1], pending_list.list[child])) {
+            child++;
+        }
+        if (!arrives_before(pending_list.list[child], last)) break;
+        pending_list.list[i] = pending_list.list[child];
+        i = child;
+    }
+    if (pending_list.count > 0) pending_list.list[i] = last;
+    scheduler_unlock();
+    return first;
+}
+
+// Forget queued arrivals (the PCBs themselves are not freed)
+void clear_pending_processes() {
+    scheduler_lock();
+    pending_list.count = 0;
+    scheduler_unlock();
+}
 
 // Initialize a process queue
 static void init_process_queue(ProcessQueue* queue) {
@@ -30,7 +125,10 @@ void add_to_queue(ProcessQueue* queue, PCB* pcb) {
         queue->capacity *= 2;
         queue->processes = realloc(queue->processes, queue->capacity * sizeof(PCB*));
     }
-    queue->processes[queue->size++] = pcb;
+    queue->processes[queue->size] = pcb;
+    // Other CPUs read the size without the lock (cpu_load)
+    __atomic_store_n(&queue->size, queue->size + 1, __ATOMIC_RELAXED);
+    event_emit(EVENT_QUEUE, pcb->pid, 1, 0);
 }
 
 // Remove a process from a queue
@@ -51,15 +149,19 @@ PCB* remove_from_queue(ProcessQueue* queue, int index) {
     }
 
     PCB* pcb = queue->processes[index];  
+    bool verbose = scheduler && scheduler->verbose;
     
-    printf("[DEBUG] remove_from_queue: removing PID %d from index %d (queue size before: %d)\n",
-            pcb->pid, index, queue->size);  
+    if (verbose) {
+        printf("[DEBUG] remove_from_queue: removing PID %d from index %d (queue size before: %d)\n",
+            pcb->pid, index, queue->size);
+    }
     
     for (int i = index; i < queue->size - 1; i++) {
         queue->processes[i] = queue->processes[i + 1];
     }
-    queue->size--;
-    printf("[DEBUG] Queue state after removal (size=%d)\n", queue->size);
+    __atomic_store_n(&queue->size, queue->size - 1, __ATOMIC_RELAXED);
+    event_emit(EVENT_QUEUE, pcb->pid, 0, 0);
+    if (verbose) printf("[DEBUG] Queue state after removal (size=%d)\n", queue->size);
     return pcb;
 }
 
@@ -68,51 +170,274 @@ void init_scheduler(Scheduler* scheduler, SchedulingAlgorithm algorithm, int qua
     printf("[DEBUG C] Inside init_scheduler: setting algorithm to %d\n", algorithm);
     scheduler->algorithm = algorithm;
     scheduler->quantum = quantum;
-    scheduler->running_process = NULL;
     scheduler->clock_cycle = 0;
+    scheduler->aging_clock = 0;
     printf("[INIT] Scheduler initialized with Clock Cycle = %d\n", scheduler->clock_cycle);
     scheduler->next_pid = 1;
     scheduler->initialized = 1;
+    scheduler->num_cpus = 1;
+    scheduler->work_stealing = 1;
+    scheduler->parallel = 0;
+    scheduler->event_driven = 0;
+    scheduler->verbose = 1;
 
+    for (int c = 0; c < MAX_CPUS; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        cpu->id = c;
+        pthread_mutex_init(&cpu->lock, NULL);
+        cpu->running_process = NULL;
+        for (int i = 0; i < 4; i++) {
+            init_process_queue(&cpu->ready_queues[i]);
+        }
+        cfs_init(&cpu->cfs_queue);
+        cpu->busy_cycles = 0;
+        cpu->idle_cycles = 0;
+        cpu->dispatches = 0;
+        cpu->migrations = 0;
+        cpu->steals = 0;
+    }
     for (int i = 0; i < 4; i++) {
-        init_process_queue(&scheduler->ready_queues[i]);
         printf("[TRACE] init_scheduler: initialized ready_queues[%d] => processes=%p\n",
-            i, scheduler->ready_queues[i].processes);
+            i, scheduler->cpus[0].ready_queues[i].processes);
     }
     init_process_queue(&scheduler->blocked_queue);
+    scheduler->min_granularity = CFS_DEFAULT_MIN_GRANULARITY;
+    scheduler->target_latency = CFS_DEFAULT_TARGET_LATENCY;
+    scheduler->boost_period = DEFAULT_BOOST_PERIOD;
+    scheduler->aging_threshold[0] = 0;  // nothing above the top level
+    for (int i = 1; i < 4; i++) {
+        scheduler->aging_threshold[i] = DEFAULT_AGING_THRESHOLD << (i - 1);
+    }
+    scheduler->starvation_threshold = DEFAULT_STARVATION_THRESHOLD;
+    scheduler->instructions_per_cycle = 1;
+    memset(&scheduler->metrics, 0, sizeof(scheduler->metrics));
     print_queues_state(scheduler);
 }
 
+// Configure CFS slice sizing; values below 1 keep the current setting
+void set_cfs_params(Scheduler* scheduler, int min_granularity, int target_latency) {
+    if (!scheduler) return;
+    if (min_granularity >= 1) scheduler->min_granularity = min_granularity;
+    if (target_latency >= 1) scheduler->target_latency = target_latency;
+    printf("[CFS] min_granularity=%d, target_latency=%d\n",
+        scheduler->min_granularity, scheduler->target_latency);
+}
+
+// MLFQ priority boost period; 0 disables boosting
+void set_boost_period(Scheduler* scheduler, int cycles) {
+    if (!scheduler) return;
+    scheduler->boost_period = cycles > 0 ? cycles : 0;
+    printf("[MLFQ] boost_period=%d\n", scheduler->boost_period);
+}
+
+// Cycles a process may wait at a level (1-4) before aging promotes it; 0 disables
+void set_aging_threshold(Scheduler* scheduler, int level, int cycles) {
+    if (!scheduler || level < 2 || level > 4) return;
+    scheduler->aging_threshold[level - 1] = cycles > 0 ? cycles : 0;
+    printf("[MLFQ] aging_threshold[%d]=%d\n", level, scheduler->aging_threshold[level - 1]);
+}
+
+// Cycles READY without running before a starvation alarm; 0 disables alarms
+void set_starvation_threshold(Scheduler* scheduler, int cycles) {
+    if (!scheduler) return;
+    scheduler->starvation_threshold = cycles > 0 ? cycles : 0;
+    printf("[SCHED] starvation_threshold=%d\n", scheduler->starvation_threshold);
+}
+
+// Instructions a CPU may execute in one cycle. The first goes through the full
+// interpreter; the rest only while they are plain arithmetic, assigns and branches.
+void set_instructions_per_cycle(Scheduler* scheduler, int count) {
+    if (!scheduler) return;
+    if (count < 1) count = 1;
+    if (count > MAX_INSTRUCTIONS_PER_CYCLE) count = MAX_INSTRUCTIONS_PER_CYCLE;
+    scheduler->instructions_per_cycle = count;
+    printf("[SCHED] instructions_per_cycle=%d (%s dispatch)\n", count, interpreter_dispatch_mode());
+}
+
+// Move an already-ready process to another queue without losing the wait it built up
+static void requeue_process(Scheduler* scheduler, PCB* pcb) {
+    int ready_since = pcb->ready_since;
+    pcb->queued_cpu = -1;
+    add_process(scheduler, pcb);
+    pcb->ready_since = ready_since;
+}
+
+// Change the number of simulated CPUs; queued work on removed CPUs is redistributed
+void set_cpu_count(Scheduler* scheduler, int num_cpus) {
+    if (!scheduler) return;
+    if (num_cpus < 1) num_cpus = 1;
+    if (num_cpus > MAX_CPUS) num_cpus = MAX_CPUS;
+
+    // Workers are sized to the CPU count; they restart on the next parallel cycle
+    smp_stop();
+
+    int old_count = scheduler->num_cpus;
+    scheduler->num_cpus = num_cpus;
+    for (int c = num_cpus; c < old_count; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        if (cpu->running_process) {
+            PCB* pcb = cpu->running_process;
+            cpu->running_process = NULL;
+            add_process(scheduler, pcb);
+        }
+        for (int i = 0; i < 4; i++) {
+            while (cpu->ready_queues[i].size > 0) {
+                requeue_process(scheduler, remove_from_queue(&cpu->ready_queues[i], 0));
+            }
+        }
+        PCB* pcb;
+        while ((pcb = cfs_pick_next(&cpu->cfs_queue)) != NULL) {
+            requeue_process(scheduler, pcb);
+        }
+    }
+    printf("[SMP] Simulating %d CPU(s)\n", scheduler->num_cpus);
+}
+
+// Switch policy mid-run: queued processes move into the new policy's run queues.
+// Running processes keep their CPU until their next scheduling decision.
+void set_scheduling_algorithm(Scheduler* scheduler, SchedulingAlgorithm algorithm) {
+    if (!scheduler || scheduler->algorithm == algorithm) return;
+    PCB** queued = NULL;
+    int count = 0;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        int load = cpu_load(cpu);
+        if (load == 0) continue;
+        PCB** grown = realloc(queued, (count + load) * sizeof(PCB*));
+        if (!grown) {
+            printf("[ERROR] Failed to switch scheduling algorithm\n");
+            free(queued);
+            return;
+        }
+        queued = grown;
+        for (int i = 0; i < 4; i++) {
+            while (cpu->ready_queues[i].size > 0) {
+                queued[count++] = remove_from_queue(&cpu->ready_queues[i], 0);
+            }
+        }
+        PCB* pcb;
+        while ((pcb = cfs_pick_next(&cpu->cfs_queue)) != NULL) {
+            queued[count++] = pcb;
+        }
+    }
+    scheduler->algorithm = algorithm;
+    for (int i = 0; i < count; i++) {
+        requeue_process(scheduler, queued[i]);
+    }
+    free(queued);
+    printf("[INFO] Scheduling algorithm switched to %d (%d queued process(es) moved)\n", algorithm, count);
+}
+
+// Toggle running each CPU's cycle on its own thread (only matters with more than one CPU)
+void set_parallel_execution(Scheduler* scheduler, int enabled) {
+    if (!scheduler) return;
+    scheduler->parallel = enabled ? 1 : 0;
+    if (!scheduler->parallel) smp_stop();
+    printf("[SMP] Parallel execution %s\n", scheduler->parallel ? "enabled" : "disabled");
+}
+
+// Per-cycle and per-dispatch chatter; worker threads otherwise serialize on stdout
+void set_verbose_output(Scheduler* scheduler, int enabled) {
+    if (!scheduler) return;
+    scheduler->verbose = enabled ? 1 : 0;
+}
+
+// Processes waiting in a CPU's run queues.
+// Other CPUs read it without the CPU's lock, so the counters are written with atomic
+// stores and read with atomic loads; under parallel execution it is only a hint.
+static int cpu_queued(const Cpu* cpu) {
+    int queued = __atomic_load_n(&cpu->cfs_queue.count, __ATOMIC_RELAXED);
+    for (int i = 0; i < 4; i++) {
+        queued += __atomic_load_n(&cpu->ready_queues[i].size, __ATOMIC_RELAXED);
+    }
+    return queued;
+}
+
+static bool cpu_busy(const Cpu* cpu) {
+    return __atomic_load_n(&cpu->running_process, __ATOMIC_RELAXED) != NULL;
+}
+
+// Only the CPU's own thread changes running_process during a cycle; see cpu_queued
+static void set_running(Cpu* cpu, PCB* pcb) {
+    __atomic_store_n(&cpu->running_process, pcb, __ATOMIC_RELAXED);
+}
+
+// Runnable work on a CPU, counting the process it is running
+int cpu_load(const Cpu* cpu) {
+    return cpu_queued(cpu) + (cpu_busy(cpu) ? 1 : 0);
+}
+
+// Prefer the CPU the process last ran on unless another allowed CPU is clearly less loaded
+static Cpu* select_cpu(Scheduler* scheduler, PCB* pcb) {
+    Cpu* best = NULL;
+    int best_load = 0;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        if (!pcb_can_run_on(pcb, c)) continue;
+        int load = cpu_load(&scheduler->cpus[c]);
+        if (!best || load < best_load) {
+            best = &scheduler->cpus[c];
+            best_load = load;
+        }
+    }
+    if (!best) {
+        printf("[WARN] PID %d has no allowed CPU among %d; ignoring affinity.\n",
+            pcb->pid, scheduler->num_cpus);
+        return &scheduler->cpus[0];
+    }
+
+    int last = pcb->last_cpu;
+    if (last >= 0 && last < scheduler->num_cpus && pcb_can_run_on(pcb, last) &&
+        cpu_load(&scheduler->cpus[last]) <= best_load + 1) {
+        return &scheduler->cpus[last];
+    }
+    return best;
+}
+
 // Add a process to the scheduler
 void add_process(Scheduler* scheduler, PCB* pcb) {
     if (!scheduler || !pcb) {
         printf("[ERROR] add_process called with NULL scheduler or pcb!\n");
         return;
     }
-    print_queues_state(scheduler);
-    printf("[TRACE] add_process: priority=%d, ready_queues[%d].processes=%p\n",
-        pcb->priority,
-        scheduler->algorithm == MLFQ ? pcb->priority - 1 : 0,
-        scheduler->algorithm == MLFQ ? scheduler->ready_queues[pcb->priority - 1].processes 
-                                        : scheduler->ready_queues[0].processes);
+    bool verbose = scheduler->verbose;
+    // Full queue dumps would walk other CPUs' queues while their threads modify them
+    bool dump_queues = verbose && !(scheduler->parallel && scheduler->num_cpus > 1);
+    if (dump_queues) print_queues_state(scheduler);
+    if (verbose) printf("[TRACE] add_process: priority=%d, queued_cpu=%d\n", pcb_priority(pcb), pcb->queued_cpu);
 
     // Handle pending processes (future arrivals)
     if (pcb->arrival_time > scheduler->clock_cycle) {
-        printf("[CHECK] Adding PID %d to Pending List (Arrival: %d, Clock: %d)\n", pcb->pid, pcb->arrival_time, scheduler->clock_cycle);
-        pending_list.list[pending_list.count++] = pcb;
+        if (verbose) printf("[CHECK] Adding PID %d to Pending List (Arrival: %d, Clock: %d)\n", pcb->pid, pcb->arrival_time, scheduler->clock_cycle);
+        add_pending_process(pcb);
         return;
-    } else {
+    } else if (verbose) {
         printf("[CHECK] Adding PID %d DIRECTLY to Ready Queue (Arrival: %d, Clock: %d)\n", pcb->pid, pcb->arrival_time, scheduler->clock_cycle);
     }
 
+    if (pcb->queued_cpu >= 0) {
+        if (verbose) printf("[DEBUG] Skipping add: PID %d is already queued on CPU %d\n", pcb->pid, pcb->queued_cpu);
+        return;
+    }
+
     set_pcb_state(pcb, READY);
+    mark_queued(scheduler, pcb);
+    pcb->ready_since = scheduler->aging_clock;
 
-    printf("[DEBUG] ✅✅ Added PID %d to READY queue (Priority: %d)\n", pcb->pid, pcb->priority);
-    print_scheduler_status(scheduler);
+    if (verbose) printf("[DEBUG] ✅✅ Added PID %d to READY queue (Priority: %d)\n", pcb->pid, pcb_priority(pcb));
+    if (dump_queues) print_scheduler_status(scheduler);
+
+    Cpu* cpu = select_cpu(scheduler, pcb);
+    pthread_mutex_lock(&cpu->lock);
 
     // Check priority before adding to MLFQ
-    int priority = pcb->priority;
-    if (scheduler->algorithm == MLFQ) {
+    int priority = pcb_priority(pcb);
+    if (scheduler->algorithm == CFS) {
+        cfs_enqueue(&cpu->cfs_queue, pcb);
+        if (verbose) {
+            printf("[DEBUG] Added PID %d to CFS run queue of CPU %d (vruntime: %lld, weight: %d)\n",
+                pcb->pid, cpu->id, pcb->vruntime, pcb->weight);
+        }
+    } else if (scheduler->algorithm == MLFQ) {
 
         if (priority < 1) {
             printf("[WARN] PCB PID %d had priority < 1 (was %d), fixing to 1.\n", pcb->pid, priority);
@@ -122,160 +447,257 @@ void add_process(Scheduler* scheduler, PCB* pcb) {
             priority = 4;
         }
 
-        if (!scheduler->ready_queues[priority - 1].processes) {
+        if (!cpu->ready_queues[priority - 1].processes) {
             printf("[FATAL ERROR] ready_queues[%d] processes is NULL!\n", priority - 1);
+            pthread_mutex_unlock(&cpu->lock);
             return;
         }
 
-        ProcessQueue* queue = &scheduler->ready_queues[priority - 1];
-        bool already_in_queue = false;
-        for (int i = 0; i < queue->size; i++) {
-            if (queue->processes[i] == pcb) {
-                already_in_queue = true;
-                break;
+        add_to_queue(&cpu->ready_queues[priority - 1], pcb);
+        if (verbose) {
+            printf("[DEBUG] Added PID %d to MLFQ ready queue of CPU %d (Priority: %d, Arrival: %d)\n",
+                pcb->pid, cpu->id, priority, pcb->arrival_time);
+        }
+    } else {
+        if (!cpu->ready_queues[0].processes) {
+            printf("[FATAL ERROR] ready_queues[0] processes is NULL!\n");
+            pthread_mutex_unlock(&cpu->lock);
+            return;
+        }
+
+        add_to_queue(&cpu->ready_queues[0], pcb);
+        if (verbose) printf("[DEBUG] Added PID %d to ready queue of CPU %d (Arrival: %d)\n", pcb->pid, cpu->id, pcb->arrival_time);
+    }
+    // reposition_process reads it before taking any CPU's lock
+    __atomic_store_n(&pcb->queued_cpu, cpu->id, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&cpu->lock);
+}
+
+// Move a queued process to the MLFQ level that matches its current (possibly inherited) priority
+void reposition_process(Scheduler* scheduler, PCB* pcb) {
+    if (!scheduler || !pcb || scheduler->algorithm != MLFQ) return;
+    int cpu_id = __atomic_load_n(&pcb->queued_cpu, __ATOMIC_RELAXED);
+    if (cpu_id < 0 || cpu_id >= scheduler->num_cpus) return;
+
+    Cpu* cpu = &scheduler->cpus[cpu_id];
+    pthread_mutex_lock(&cpu->lock);
+    if (pcb->queued_cpu == cpu_id) {
+        int priority = pcb_priority(pcb);
+        int target = priority < 1 ? 0 : (priority > 4 ? 3 : priority - 1);
+        for (int lvl = 0; lvl < 4; lvl++) {
+            if (lvl == target) continue;
+            ProcessQueue* queue = &cpu->ready_queues[lvl];
+            for (int i = 0; i < queue->size; i++) {
+                if (queue->processes[i] == pcb) {
+                    remove_from_queue(queue, i);
+                    // It joins the back of the new level, so its time there starts now
+                    mark_queued(scheduler, pcb);
+                    add_to_queue(&cpu->ready_queues[target], pcb);
+                    printf("[MLFQ] PID %d moved from Priority %d to Priority %d on CPU %d\n",
+                        pcb->pid, lvl + 1, target + 1, cpu->id);
+                    lvl = 4;
+                    break;
+                }
             }
         }
+    }
+    pthread_mutex_unlock(&cpu->lock);
+}
 
-        if (!already_in_queue) {
-            add_to_queue(queue, pcb);
-            printf("[DEBUG] Added PID %d to MLFQ ready queue (Priority: %d, Arrival: %d)\n", pcb->pid, priority, pcb->arrival_time);
-        } else {
-            printf("[DEBUG] Skipping add: PID %d is already in MLFQ ready queue (Priority: %d)\n", pcb->pid, priority);
+// Take the first process in the queue that is allowed on the given CPU
+static PCB* take_allowed(ProcessQueue* queue, int cpu_id) {
+    for (int i = 0; i < queue->size; i++) {
+        if (pcb_can_run_on(queue->processes[i], cpu_id)) {
+            return remove_from_queue(queue, i);
         }
+    }
+    return NULL;
+}
 
-    } else {
-        if (!scheduler->ready_queues[0].processes) {
-            printf("[FATAL ERROR] ready_queues[0] processes is NULL!\n");
-            return;
+// Idle CPU pulls one queued process from the busiest CPU that has one it may run
+static PCB* steal_work(Scheduler* scheduler, Cpu* thief) {
+    Cpu* victim = NULL;
+    int victim_load = 1;  // only steal from a CPU with work waiting behind its running process
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        if (cpu == thief) continue;
+        int queued = cpu_queued(cpu);
+        int load = queued + (cpu_busy(cpu) ? 1 : 0);
+        if (queued >= victim_load && load > victim_load) {
+            victim = cpu;
+            victim_load = load;
         }
+    }
+    if (!victim) return NULL;
+    // Never wait on a busy victim; the thief just stays idle this cycle
+    if (pthread_mutex_trylock(&victim->lock) != 0) return NULL;
 
-        ProcessQueue* queue = &scheduler->ready_queues[0];
-        bool already_in_queue = false;
-        for (int i = 0; i < queue->size; i++) {
-            if (queue->processes[i] == pcb) {
-                already_in_queue = true;
+    PCB* stolen = NULL;
+    if (scheduler->algorithm == CFS) {
+        for (PCB* pcb = cfs_peek(&victim->cfs_queue); pcb; pcb = cfs_next(pcb)) {
+            if (pcb_can_run_on(pcb, thief->id)) {
+                stolen = pcb;
+                cfs_dequeue(&victim->cfs_queue, pcb);
                 break;
             }
         }
-
-        if (!already_in_queue) {
-            add_to_queue(queue, pcb);
-            printf("[DEBUG] Added PID %d to ready queue (Arrival: %d)\n", pcb->pid, pcb->arrival_time);
-        } else {
-            printf("[DEBUG] Skipping add: PID %d is already in ready queue\n", pcb->pid);
+    } else {
+        for (int i = 0; i < 4 && !stolen; i++) {
+            stolen = take_allowed(&victim->ready_queues[i], thief->id);
         }
     }
+    if (stolen) __atomic_store_n(&stolen->queued_cpu, -1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&victim->lock);
+    if (!stolen) return NULL;
+
+    thief->steals++;
+    if (scheduler->verbose) printf("[SMP] CPU %d stole PID %d from CPU %d\n", thief->id, stolen->pid, victim->id);
+    return stolen;
 }
 
-// Schedule next process based on algorithm
+// Schedule next process on CPU 0 (uniprocessor callers)
 PCB* schedule_next_process(Scheduler* scheduler) {
-    printf("[DEBUG] Scheduling Algorithm: %d (0=FCFS,1=RR,2=MLFQ)\n", scheduler->algorithm);
-    printf("[DEBUG] Checking ready queues:\n");
-    for (int i = 0; i < 4; i++) {
-        printf("Priority %d: %d processes\n", i + 1, scheduler->ready_queues[i].size);
-    }
     if (!scheduler) return NULL;
+    return schedule_next_process_on(scheduler, &scheduler->cpus[0]);
+}
+
+static void check_starvation(Scheduler* scheduler, PCB* pcb, int cpu_id);
+
+// Schedule next process based on algorithm
+PCB* schedule_next_process_on(Scheduler* scheduler, Cpu* cpu) {
+    if (!scheduler || !cpu) return NULL;
+    bool verbose = scheduler->verbose;
+    if (verbose) {
+        printf("[DEBUG] Scheduling Algorithm: %d (0=FCFS,1=RR,2=MLFQ,3=CFS) on CPU %d\n", scheduler->algorithm, cpu->id);
+        printf("[DEBUG] Checking ready queues:\n");
+        for (int i = 0; i < 4; i++) {
+            printf("Priority %d: %d processes\n", i + 1, cpu->ready_queues[i].size);
+        }
+    }
 
     PCB* next_process = NULL;
+    pthread_mutex_lock(&cpu->lock);
     switch (scheduler->algorithm) {
         case FCFS:
-            if (scheduler->ready_queues[0].size > 0) {
-                next_process = remove_from_queue(&scheduler->ready_queues[0], 0);
+            if (cpu->ready_queues[0].size > 0) {
+                next_process = remove_from_queue(&cpu->ready_queues[0], 0);
             }
             break;
         case RR:
-            if (scheduler->ready_queues[0].size > 0) {
-                next_process = remove_from_queue(&scheduler->ready_queues[0], 0);
-                if (next_process) {
-                    next_process->quantum_remaining = scheduler->quantum;
-                    printf("[Round Robin] Scheduled PID %d with quantum %d\n",
-                        next_process->pid, next_process->quantum_remaining);
-                } else {
+            if (cpu->ready_queues[0].size > 0) {
+                next_process = remove_from_queue(&cpu->ready_queues[0], 0);
+                if (!next_process) {
                     printf("[ERROR] remove_from_queue returned NULL in RR!\n");
                 }
             }
             break;
         case MLFQ:
             for (int i = 0; i < 4; i++) {
-                if (scheduler->ready_queues[i].size > 0) {
-                    next_process = remove_from_queue(&scheduler->ready_queues[i], 0);
-                    if (next_process) {
-                        printf("[MLFQ] Scheduled PID %d from Priority %d\n", next_process->pid, i + 1);
-                        next_process->quantum_remaining = (1 << i);  
-                    } else {
+                if (cpu->ready_queues[i].size > 0) {
+                    next_process = remove_from_queue(&cpu->ready_queues[i], 0);
+                    if (!next_process) {
                         printf("[ERROR] remove_from_queue returned NULL in MLFQ (Priority %d)\n", i + 1);
                     }
                     break;
                 }
             }
             break;
+        case CFS:
+            next_process = cfs_pick_next(&cpu->cfs_queue);
+            break;
     }
     if (next_process) {
-        set_pcb_state(next_process, RUNNING);
-        printf("[DEBUG] ▶️▶️ PID %d is now RUNNING (Priority: %d)\n", next_process->pid, next_process->priority);
+        __atomic_store_n(&next_process->queued_cpu, -1, __ATOMIC_RELAXED);
     }
-    return next_process;
-}
-
-// Update scheduler state
-void update_scheduler(Scheduler* scheduler) {
-    if (!scheduler) return;
-
-    if (scheduler->running_process) {
-        if (is_in_blocked_queue(scheduler, scheduler->running_process)) {
-            printf("✅ PID %d is in the blocked queue.\n", scheduler->running_process->pid);
-        } else {
-            printf("❌ PID %d is NOT in the blocked queue.\n", scheduler->running_process->pid);
-        }
+    pthread_mutex_unlock(&cpu->lock);
+    if (!next_process && scheduler->work_stealing && scheduler->num_cpus > 1) {
+        next_process = steal_work(scheduler, cpu);
     }
+    if (!next_process) return NULL;
 
-    // Check if the running process is still running
-    if (scheduler->running_process) {
-        if (scheduler->running_process->state == TERMINATED) {
-            printf("✅ [INFO] Process PID=%d has finished execution at clock cycle %d.\n",
-                scheduler->running_process->pid,
-                scheduler->clock_cycle);
-            // Remove the terminated process (if needed)
-            scheduler->running_process = NULL;
-        }
-        else if (scheduler->algorithm != FCFS) {
-            scheduler->running_process->quantum_remaining--;
-            if (scheduler->algorithm == RR) {
-                printf("[Round Robin] PID %d quantum left: %d\n",
-                    scheduler->running_process->pid,
-                    scheduler->running_process->quantum_remaining);
-            }
-            if (scheduler->running_process->quantum_remaining <= 0) {
-                printf("⏳ [INFO] Quantum expired for PID %d, re-queuing.\n",
-                    scheduler->running_process->pid);
-                set_pcb_state(scheduler->running_process, READY);
-                if (scheduler->algorithm == MLFQ) {
-                    int current_priority = scheduler->running_process->priority;
-                    if (current_priority < 4) {
-                        set_pcb_priority(scheduler->running_process, current_priority + 1);
-                        printf("🔄 [MLFQ] PID %d demoted to priority %d.\n",
-                            scheduler->running_process->pid,
-                            scheduler->running_process->priority);
-                    }
-                }
-                add_process(scheduler, scheduler->running_process);
-                scheduler->running_process = NULL;
+    switch (scheduler->algorithm) {
+        case RR:
+            next_process->quantum_remaining = scheduler->quantum;
+            if (verbose) {
+                printf("[Round Robin] Scheduled PID %d with quantum %d\n",
+                    next_process->pid, next_process->quantum_remaining);
             }
+            break;
+        case MLFQ: {
+            int level = pcb_priority(next_process) - 1;
+            if (level < 0) level = 0;
+            if (level > 3) level = 3;
+            if (verbose) printf("[MLFQ] Scheduled PID %d from Priority %d\n", next_process->pid, level + 1);
+            next_process->quantum_remaining = (1 << level);
+            break;
         }
+        case CFS:
+            pthread_mutex_lock(&cpu->lock);
+            next_process->quantum_remaining = cfs_timeslice(&cpu->cfs_queue, next_process,
+                scheduler->min_granularity, scheduler->target_latency);
+            pthread_mutex_unlock(&cpu->lock);
+            if (verbose) {
+                printf("[CFS] Scheduled PID %d (vruntime: %lld) with slice %d\n",
+                    next_process->pid, next_process->vruntime, next_process->quantum_remaining);
+            }
+            break;
+        default:
+            break;
     }
 
-    // If no process is running, pick the next one
-    if (!scheduler->running_process) {
-        scheduler->running_process = schedule_next_process(scheduler);
-        if (scheduler->running_process) {
-            printf("▶️ [INFO] Scheduled PID %d to run (Priority: %d).\n",
-                scheduler->running_process->pid,
-                scheduler->running_process->priority);
-    } else {
-            printf("⚠️ [INFO] No process scheduled to run at clock cycle %d.\n",
-                scheduler->clock_cycle);
+    if (next_process->last_cpu >= 0 && next_process->last_cpu != cpu->id) {
+        cpu->migrations++;
+        if (verbose) {
+            printf("[SMP] PID %d migrated from CPU %d to CPU %d\n", next_process->pid, next_process->last_cpu, cpu->id);
         }
     }
+    next_process->last_cpu = cpu->id;
+    cpu->dispatches++;
+
+    int ready_wait = pcb_ready_wait(scheduler, next_process);
+    scheduler_lock();
+    // Aging only looks at queue heads, so a wait past the threshold may first be seen here
+    check_starvation(scheduler, next_process, cpu->id);
+    SchedulerMetrics* metrics = &scheduler->metrics;
+    metrics->dispatches++;
+    metrics->total_ready_wait += ready_wait;
+    if (ready_wait > metrics->max_ready_wait) {
+        metrics->max_ready_wait = ready_wait;
+        metrics->max_ready_wait_pid = next_process->pid;
+    }
+    scheduler_unlock();
+    next_process->starving = 0;
+
+    set_pcb_state(next_process, RUNNING);
+    if (verbose) {
+        printf("[DEBUG] ▶️▶️ PID %d is now RUNNING on CPU %d (Priority: %d)\n", next_process->pid, cpu->id, pcb_priority(next_process));
+    }
+    return next_process;
+}
+
+// Move a process one MLFQ level up (priority 1 is the top)
+void promote_process(PCB* pcb) {
+    if (!pcb || pcb->base_priority <= 1) return;
+    set_pcb_priority(pcb, pcb->base_priority - 1);
+    printf("⬆️ [MLFQ] PID %d promoted to priority %d.\n", pcb->pid, pcb_priority(pcb));
+}
+
+// Move a process one MLFQ level down (priority 4 is the bottom)
+void demote_process(PCB* pcb) {
+    if (!pcb || pcb->base_priority >= 4) return;
+    set_pcb_priority(pcb, pcb->base_priority + 1);
+    printf("🔄 [MLFQ] PID %d demoted to priority %d.\n", pcb->pid, pcb_priority(pcb));
+}
+
+// This runs every step, so long queues are cut short
+#define STATUS_PID_LIMIT 16
+
+static void print_queue_pids(const ProcessQueue* queue) {
+    int shown = queue->size < STATUS_PID_LIMIT ? queue->size : STATUS_PID_LIMIT;
+    for (int j = 0; j < shown; j++) {
+        printf("[PID %d] ", queue->processes[j]->pid);
+    }
+    if (queue->size > shown) printf("... (%d more)", queue->size - shown);
 }
 
 void print_scheduler_status(const Scheduler* scheduler) {
@@ -285,32 +707,41 @@ void print_scheduler_status(const Scheduler* scheduler) {
     printf("Clock Cycle: %d\n", scheduler->clock_cycle);
     printf("Algorithm: %s\n", 
         scheduler->algorithm == FCFS ? "FCFS" : 
-        scheduler->algorithm == RR ? "Round Robin" : "MLFQ");
+        scheduler->algorithm == RR ? "Round Robin" :
+        scheduler->algorithm == CFS ? "CFS" : "MLFQ");
 
-    if (scheduler->running_process) {
-        printf("Running Process: PID %d | Priority: %d | PC: %d\n",
-            scheduler->running_process->pid,
-            scheduler->running_process->priority,
-            scheduler->running_process->program_counter);
-    } else {
-        printf("No process is currently running.\n");
-    }
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        const Cpu* cpu = &scheduler->cpus[c];
+        if (scheduler->num_cpus > 1) {
+            printf("\n--- CPU %d ---\n", cpu->id);
+        }
 
-    printf("\nReady Queues:\n");
-    for (int i = 0; i < 4; i++) {
-        printf("  Priority %d (%d processes): ", i + 1, scheduler->ready_queues[i].size);
-        for (int j = 0; j < scheduler->ready_queues[i].size; j++) {
-            PCB* p = scheduler->ready_queues[i].processes[j];
-            printf("[PID %d] ", p->pid);
+        if (cpu->running_process) {
+            printf("Running Process: PID %d | Priority: %d | PC: %d\n",
+                cpu->running_process->pid,
+                pcb_priority(cpu->running_process),
+                cpu->running_process->program_counter);
+        } else {
+            printf("No process is currently running.\n");
+        }
+
+        if (scheduler->algorithm == CFS) {
+            PCB* leftmost = cfs_peek(&cpu->cfs_queue);
+            printf("\nCFS Run Queue: %d processes, min_vruntime=%lld, leftmost=PID %d\n",
+                cpu->cfs_queue.count, cpu->cfs_queue.min_vruntime,
+                leftmost ? leftmost->pid : -1);
+        }
+
+        printf("\nReady Queues:\n");
+        for (int i = 0; i < 4; i++) {
+            printf("  Priority %d (%d processes): ", i + 1, cpu->ready_queues[i].size);
+            print_queue_pids(&cpu->ready_queues[i]);
+            printf("\n");
         }
-        printf("\n");
     }
 
     printf("\nBlocked Queue (%d processes): ", scheduler->blocked_queue.size);
-    for (int j = 0; j < scheduler->blocked_queue.size; j++) {
-        PCB* p = scheduler->blocked_queue.processes[j];
-        printf("[PID %d] ", p->pid);
-    }
+    print_queue_pids(&scheduler->blocked_queue);
     printf("\n========================================================\n\n");
 }
 
@@ -318,13 +749,20 @@ void destroy_scheduler(Scheduler* scheduler) {
     print_queues_state(scheduler);
     printf("[TRACE] destroy_scheduler called! Cleaning up memory...\n");
     if (!scheduler) return;
-    for (int i = 0; i < 4; i++) {
-        if (scheduler->ready_queues[i].processes) {
-            free(scheduler->ready_queues[i].processes);
-            scheduler->ready_queues[i].processes = NULL;
-            scheduler->ready_queues[i].size = 0;
-            scheduler->ready_queues[i].capacity = 0;
+    smp_stop();
+    for (int c = 0; c < MAX_CPUS; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        for (int i = 0; i < 4; i++) {
+            if (cpu->ready_queues[i].processes) {
+                free(cpu->ready_queues[i].processes);
+                cpu->ready_queues[i].processes = NULL;
+                cpu->ready_queues[i].size = 0;
+                cpu->ready_queues[i].capacity = 0;
+            }
         }
+        cfs_init(&cpu->cfs_queue);
+        cpu->running_process = NULL;
+        pthread_mutex_destroy(&cpu->lock);
     }
     if (scheduler->blocked_queue.processes) {
         free(scheduler->blocked_queue.processes);
@@ -334,95 +772,387 @@ void destroy_scheduler(Scheduler* scheduler) {
 
 }
 
+static void raise_starvation_alarm(Scheduler* scheduler, PCB* pcb, int cpu_id) {
+    pcb->starving = 1;
+    scheduler->metrics.starvation_alarms++;
+    char log_msg[160];
+    snprintf(log_msg, sizeof(log_msg), " [PID %d] Starvation alarm: READY for %d cycles on CPU %d (Priority: %d).",
+        pcb->pid, pcb_ready_wait(scheduler, pcb), cpu_id, pcb_priority(pcb));
+    log_event(&logger, log_msg);
+}
 
-void scheduler_step() {
-    print_scheduler_status(scheduler);
-    scheduler->clock_cycle++;
+static void check_starvation(Scheduler* scheduler, PCB* pcb, int cpu_id) {
+    if (!pcb->starving && scheduler->starvation_threshold > 0 &&
+        pcb_ready_wait(scheduler, pcb) >= scheduler->starvation_threshold) {
+        raise_starvation_alarm(scheduler, pcb, cpu_id);
+    }
+}
 
-    for (int i = 0; i < pending_list.count; ) {
-        PCB* pcb = pending_list.list[i];
-        if (pcb->program_counter >= pcb->instruction_count) {
-            printf("[ERROR] PCB program_counter (%d) >= instruction_count (%d) for PID %d\n",
-                pcb->program_counter, pcb->instruction_count, pcb->pid);
+// pcb starts its time in a (new) queue now
+void mark_queued(Scheduler* scheduler, PCB* pcb) {
+    pcb->queued_at = scheduler->aging_clock;
+}
+
+int pcb_time_in_queue(const Scheduler* scheduler, const PCB* pcb) {
+    return scheduler->aging_clock - pcb->queued_at;
+}
+
+int pcb_ready_wait(const Scheduler* scheduler, const PCB* pcb) {
+    return scheduler->aging_clock - pcb->ready_since;
+}
+
+// Once per clock cycle: charge a cycle of waiting to every queued process, promote MLFQ
+// processes that waited past their level's aging threshold, and raise starvation alarms.
+// Waits are stamps against aging_clock, so charging is one increment. Each MLFQ level
+// is ordered by queued_at, so only its head can be due for promotion; starvation is
+// checked at the heads here and again at dispatch. Runs between CPU cycles, so no
+// worker thread is executing.
+void age_processes(Scheduler* scheduler) {
+    if (!scheduler) return;
+    scheduler->aging_clock++;
+
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        pthread_mutex_lock(&cpu->lock);
+        for (int lvl = 0; lvl < 4; lvl++) {
+            ProcessQueue* queue = &cpu->ready_queues[lvl];
+            if (queue->size > 0) check_starvation(scheduler, queue->processes[0], cpu->id);
+
+            int threshold = scheduler->aging_threshold[lvl];
+            if (scheduler->algorithm != MLFQ || lvl == 0 || threshold <= 0) continue;
+            while (queue->size > 0) {
+                PCB* pcb = queue->processes[0];
+                if (pcb_time_in_queue(scheduler, pcb) < threshold || pcb->base_priority <= 1) break;
+                promote_process(pcb);
+                scheduler->metrics.promotions++;
+                // Under an inherited boost the effective level may not change; it then
+                // goes to the back of its level, where its time starts again
+                remove_from_queue(queue, 0);
+                mark_queued(scheduler, pcb);
+                int level = pcb_priority(pcb) - 1;
+                int target = level < lvl ? level : lvl;
+                add_to_queue(&cpu->ready_queues[target], pcb);
+                if (target != lvl) check_starvation(scheduler, pcb, cpu->id);
+            }
         }
-        if (pcb->arrival_time <= scheduler->clock_cycle) {
-            add_process(scheduler, pcb);
-            for (int j = i; j < pending_list.count - 1; j++)
-                pending_list.list[j] = pending_list.list[j + 1];
-            pending_list.count--;
-        } else {
-            i++;
+        // CFS never starves a runnable process, but long waits are still worth flagging
+        PCB* leftmost = cfs_peek(&cpu->cfs_queue);
+        if (leftmost) check_starvation(scheduler, leftmost, cpu->id);
+        pthread_mutex_unlock(&cpu->lock);
+    }
+
+    scheduler->metrics.inversion_cycles += count_priority_inversions(&resource_manager);
+}
+
+// MLFQ priority boost: every process goes back to the top level, queued ones in their current order
+void boost_all_processes(Scheduler* scheduler) {
+    if (!scheduler) return;
+
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        pthread_mutex_lock(&cpu->lock);
+        for (int lvl = 1; lvl < 4; lvl++) {
+            ProcessQueue* queue = &cpu->ready_queues[lvl];
+            for (int i = 0; i < queue->size; i++) {
+                PCB* pcb = queue->processes[i];
+                set_pcb_priority(pcb, 1);
+                mark_queued(scheduler, pcb);
+                add_to_queue(&cpu->ready_queues[0], pcb);
+            }
+            queue->size = 0;
         }
+        if (cpu->running_process) set_pcb_priority(cpu->running_process, 1);
+        pthread_mutex_unlock(&cpu->lock);
     }
 
-    PCB* pcb = scheduler->running_process;
+    scheduler_lock();
+    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
+        set_pcb_priority(scheduler->blocked_queue.processes[i], 1);
+    }
+    scheduler_unlock();
+
+    scheduler->metrics.boosts++;
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), " [MLFQ] Priority boost at clock cycle %d: all processes reset to priority 1.",
+        scheduler->clock_cycle);
+    log_event(&logger, log_msg);
+}
+
+// Run one clock cycle on a single CPU; returns true if it executed an instruction.
+// Called concurrently for different CPUs when parallel execution is enabled.
+bool cpu_step(Scheduler* scheduler, Cpu* cpu) {
+    PCB* pcb = cpu->running_process;
+    bool verbose = scheduler->verbose;
     if (!pcb) {
-        printf("[TRACE] No running process found, attempting to schedule...\n");
-        pcb = schedule_next_process(scheduler);
+        if (verbose) printf("[TRACE] No running process found on CPU %d, attempting to schedule...\n", cpu->id);
+        pcb = schedule_next_process_on(scheduler, cpu);
         if (!pcb) {
-            log_event(&logger, " No process to schedule.");
-            return;
+            cpu->idle_cycles++;
+            return false;
         }
+        set_running(cpu, pcb);
     }
+    cpu->busy_cycles++;
 
-    printf("[DEBUG] >>> PCB before execution: PID=%d, PC=%d, State=%d\n",
-        pcb->pid, pcb->program_counter, pcb->state);
+    if (verbose) {
+        printf("[DEBUG] >>> PCB before execution: PID=%d, PC=%d, State=%d, CPU=%d\n",
+            pcb->pid, pcb->program_counter, pcb->state, cpu->id);
+    }
 
     set_pcb_state(pcb, RUNNING);
 
-    printf("[DEBUG] Executing instruction for PID=%d | PC=%d | InstructionCount=%d\n",
-        pcb->pid, pcb->program_counter, pcb->instruction_count);
+    if (verbose) {
+        printf("[DEBUG] Executing instruction for PID=%d | PC=%d | InstructionCount=%d\n",
+            pcb->pid, pcb->program_counter, pcb->instruction_count);
+    }
 
     bool success = false;
-    PCB* unblocked_pcb = execute_instruction(pcb, &memory, &resource_manager, &logger, &success);
-    if (unblocked_pcb) {
-        printf("[DEBUG] 🔓🔓 PID %d is UNBLOCKED and re-added to READY queue\n", unblocked_pcb->pid);
-        add_process(scheduler, unblocked_pcb);
-        printf("[DEBUG] ✅✅✅ Unblocked PID %d and re-added to READY queue (Priority: %d)\n", unblocked_pcb->pid, unblocked_pcb->priority);
+    PCB* unblocked_pcb = NULL;
+    if (pcb->stall_cycles > 0) {
+        // Still busy with a multi-cycle instruction
+        pcb->stall_cycles--;
+        success = true;
+        if (verbose) printf("[DEBUG] PID %d busy for %d more cycle(s)\n", pcb->pid, pcb->stall_cycles);
+    } else if (pcb->program_counter >= pcb->instruction_count) {
+        // Woke up from a device wait on its last instruction; it finishes now
+        success = true;
+    } else {
+        unblocked_pcb = execute_instruction(pcb, &memory, &resource_manager, &logger, &success);
+        if (success && scheduler->instructions_per_cycle > 1 && pcb->state == RUNNING && pcb->stall_cycles == 0) {
+            execute_instruction_run(pcb, scheduler->instructions_per_cycle - 1);
+        }
+    }
+    if (scheduler->algorithm == CFS) {
+        pthread_mutex_lock(&cpu->lock);
+        cfs_account(&cpu->cfs_queue, pcb, 1);
+        pthread_mutex_unlock(&cpu->lock);
+    }
+    if (unblocked_pcb && verbose) {
+        // sem_signal already queued it; another CPU may be running it by now, so never re-add here
+        printf("[DEBUG] 🔓🔓 PID %d is UNBLOCKED and was re-added to READY queue (Priority: %d)\n",
+            unblocked_pcb->pid, pcb_priority(unblocked_pcb));
     }
 
     if (!success) {
-        // The PCB state is set to BLOCKED inside sem_wait() in mutex.c, not here.
-        printf("[DEBUG] 🚫🚫🚫 PID %d is BLOCKED after execution (Instruction: %s)\n", pcb->pid, pcb->instructions[pcb->program_counter - 1]);
+        // The PCB state is set to BLOCKED inside sem_acquire() in mutex.c, not here.
+        printf("[DEBUG] 🚫🚫🚫 PID %d is BLOCKED after execution (Instruction: %s)\n", pcb->pid,
+            pcb->program_counter < pcb->instruction_count ? pcb->instructions[pcb->program_counter] : "-");
+        scheduler_lock();
         if (pcb->state == BLOCKED && !is_in_blocked_queue(scheduler, pcb)) {
-            add_to_queue(&scheduler->blocked_queue, pcb);
+            add_to_blocked_queue(scheduler, pcb);
             printf("[INFO] PID %d added to blocked queue after execution failure.\n", pcb->pid);
         }
         else if (pcb->state == BLOCKED) {
             printf("[DEBUG] PID %d is already in blocked queue, skipping add.\n", pcb->pid);
         }
-        scheduler->running_process = NULL;
-    } else if (pcb->program_counter >= pcb->instruction_count) {
+        scheduler_unlock();
+        set_running(cpu, NULL);
+    } else if (pcb->program_counter >= pcb->instruction_count && pcb->stall_cycles == 0 && pcb->state != BLOCKED) {
         set_pcb_state(pcb, TERMINATED);
         char log_msg[256];
         snprintf(log_msg, sizeof(log_msg), " [PID %d] Process completed.", pcb->pid);
         log_event(&logger, log_msg);
-        scheduler->running_process = NULL;
+        set_running(cpu, NULL);
     } else if (pcb->state != TERMINATED) {
-        /* process has executed successfully and has more instructions */
+        /* process has executed successfully and has more instructions or cycles still owed */
         if (pcb->state == BLOCKED) {
             /* it blocked during the instruction */
             printf("[DEBUG] Skipping re‑adding PID %d because it is BLOCKED.\n", pcb->pid);
-            scheduler->running_process = NULL;
+            set_running(cpu, NULL);
         } else { /* still runnable */
             if (scheduler->algorithm == FCFS) {
                 /* FCFS: keep the same process on the CPU */
-                scheduler->running_process = pcb;       /* leave it running */
+                set_running(cpu, pcb);       /* leave it running */
                 /* state already RUNNING, nothing else to do */
+            } else if (--pcb->quantum_remaining > 0) {
+                /* RR / MLFQ / CFS: keep running until the slice set at dispatch is used up */
+                set_running(cpu, pcb);
             } else {
-                /* RR / MLFQ: pre‑empt and re‑queue */
+                /* Slice used up: pre‑empt and re‑queue; MLFQ drops it a level */
                 set_pcb_state(pcb, READY);
+                if (scheduler->algorithm == MLFQ && pcb->base_priority < 4) {
+                    demote_process(pcb);
+                    scheduler_lock();
+                    scheduler->metrics.demotions++;
+                    scheduler_unlock();
+                }
+                set_running(cpu, NULL);
                 add_process(scheduler, pcb);
-                scheduler->running_process = NULL;
             }
         }
     }
+    return true;
+}
+
+static bool any_cpu_running(Scheduler* scheduler) {
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        if (scheduler->cpus[c].running_process) return true;
+    }
+    return false;
+}
+
+// Move every process whose arrival time has come from the pending heap to the ready queues
+static void admit_arrivals(Scheduler* scheduler) {
+    PCB* pcb;
+    while ((pcb = peek_pending_process()) != NULL && pcb->arrival_time <= scheduler->clock_cycle) {
+        pop_pending_process();
+        if (pcb->program_counter >= pcb->instruction_count) {
+            printf("[ERROR] PCB program_counter (%d) >= instruction_count (%d) for PID %d\n",
+                pcb->program_counter, pcb->instruction_count, pcb->pid);
+        }
+        add_process(scheduler, pcb);
+    }
+}
+
+// Earliest future cycle at which something becomes runnable on its own, -1 if nothing is scheduled
+int next_event_time(Scheduler* scheduler) {
+    if (!scheduler) return -1;
+    int next = -1;
+    PCB* arrival = peek_pending_process();
+    if (arrival) next = arrival->arrival_time;
+    int io_due = aio_next_due();
+    if (io_due >= 0 && (next < 0 || io_due < next)) next = io_due;
+    int device_due = device_next_due();
+    if (device_due >= 0 && (next < 0 || device_due < next)) next = device_due;
+    int timer_due = timer_next_expiry();
+    if (timer_due >= 0 && (next < 0 || timer_due < next)) next = timer_due;
+    return next;
+}
+
+// Arm the process timer; kind says what expire_process_timers does when it fires
+void arm_process_timer(PCB* pcb, TimerKind kind, int expires) {
+    if (!pcb) return;
+    pcb->timer.kind = kind;
+    timer_arm(&pcb->timer, expires);
+}
+
+void cancel_process_timer(PCB* pcb) {
+    if (!pcb) return;
+    timer_cancel(&pcb->timer);
+    pcb->timer.kind = TIMER_NONE;
+}
+
+// sleep: block pcb until cycle now + cycles
+void sleep_process(Scheduler* scheduler, PCB* pcb, int cycles) {
+    if (!scheduler || !pcb) return;
+    arm_process_timer(pcb, TIMER_SLEEP, scheduler->clock_cycle + cycles);
+    scheduler_lock();
+    set_pcb_state(pcb, BLOCKED);
+    add_to_blocked_queue(scheduler, pcb);
+    scheduler_unlock();
+    printf("[SCHED] PID %d sleeps until cycle %d\n", pcb->pid, pcb->timer.expires);
+}
+
+// Once per cycle: wake sleepers and time out semWaits whose timer has expired.
+// Costs one blocked-queue removal per fired timer.
+int expire_process_timers(Scheduler* scheduler) {
+    if (!scheduler) return 0;
+    Timer* expired = timer_advance(scheduler->clock_cycle);
+    int woken = 0;
+    while (expired) {
+        Timer* timer = expired;
+        expired = timer->next;
+        timer->next = NULL;
+        PCB* pcb = (PCB*)timer->owner;
+        TimerKind kind = timer->kind;
+        timer->kind = TIMER_NONE;
+        if (kind == TIMER_SEM_TIMEOUT && sem_cancel_wait(&resource_manager, pcb)) {
+            // Give up on the semaphore and carry on after the semWait
+            pcb->program_counter++;
+            char log_msg[MAX_PROGRAM_NAME_LENGTH + 128];
+            snprintf(log_msg, sizeof(log_msg), "[Event] [Program: %s | PID %d] semWait timed out at clock cycle %d",
+                pcb->program_name, pcb->pid, scheduler->clock_cycle);
+            log_event(&logger, log_msg);
+            scheduler_lock();
+            scheduler->metrics.timeouts++;
+            scheduler_unlock();
+        } else if (kind != TIMER_SLEEP) {
+            // The wait ended some other way (granted, or the process was aborted)
+            continue;
+        }
+        scheduler_lock();
+        if (remove_from_blocked_queue(scheduler, pcb)) {
+            printf("[SCHED] PID %d woke up at cycle %d\n", pcb->pid, scheduler->clock_cycle);
+            add_process(scheduler, pcb);
+            woken++;
+        }
+        scheduler_unlock();
+    }
+    return woken;
+}
+
+void set_event_driven(Scheduler* scheduler, int enabled) {
+    if (!scheduler) return;
+    scheduler->event_driven = enabled ? 1 : 0;
+    printf("[SCHED] Event-driven clock %s\n", scheduler->event_driven ? "enabled" : "disabled");
+}
+
+// Jump over cycles in which nothing can run; they still count as idle time
+static void skip_idle_cycles(Scheduler* scheduler, int cycles) {
+    scheduler->clock_cycle += cycles;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        scheduler->cpus[c].idle_cycles += cycles;
+    }
+    scheduler->metrics.idle_cycles += cycles;
+    scheduler->metrics.skipped_cycles += cycles;
+    // Only blocked processes are queued while nothing is runnable; they wait through the skip too
+    scheduler->aging_clock += cycles;
+
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), " Skipped %d idle cycle(s) to clock cycle %d.",
+        cycles, scheduler->clock_cycle);
+    log_event(&logger, log_msg);
+}
+
+void scheduler_step() {
+    if (scheduler->verbose) print_scheduler_status(scheduler);
+    int previous_clock = scheduler->clock_cycle;
+    scheduler->clock_cycle++;
+    admit_arrivals(scheduler);
+    aio_deliver(scheduler);
+    device_deliver(scheduler);
+    expire_process_timers(scheduler);
+
+    if (scheduler->event_driven && !any_cpu_running(scheduler) && is_all_queues_empty(scheduler)) {
+        int next = next_event_time(scheduler);
+        if (next > scheduler->clock_cycle) {
+            skip_idle_cycles(scheduler, next - scheduler->clock_cycle);
+            admit_arrivals(scheduler);
+            aio_deliver(scheduler);
+            device_deliver(scheduler);
+            expire_process_timers(scheduler);
+        }
+    }
+
+    age_processes(scheduler);
+    // A skip may jump over a boost point, so compare periods instead of testing the exact cycle
+    if (scheduler->algorithm == MLFQ && scheduler->boost_period > 0 &&
+        scheduler->clock_cycle / scheduler->boost_period != previous_clock / scheduler->boost_period) {
+        boost_all_processes(scheduler);
+    }
+
+    int executed = 0;
+    if (scheduler->parallel && scheduler->num_cpus > 1) {
+        executed = smp_run_cycle(scheduler);
+    } else {
+        for (int c = 0; c < scheduler->num_cpus; c++) {
+            if (cpu_step(scheduler, &scheduler->cpus[c])) executed++;
+        }
+    }
+    if (executed == 0) {
+        scheduler->metrics.idle_cycles++;
+        log_event(&logger, " No process to schedule.");
+        event_emit(EVENT_CLOCK, scheduler->clock_cycle, 0, 0);
+        return;
+    }
 
-    if (scheduler->running_process == NULL &&
+    if (!any_cpu_running(scheduler) &&
         is_all_queues_empty(scheduler) &&
         scheduler->blocked_queue.size == 0) {
         
         log_event(&logger, "✅✅ All processes have completed. System is idle.");
+        // Write-back files reach the disk once the run is over
+        vfs_sync();
         printf("[DEBUG] Finished all processes. NOT resetting anything!\n");
     }
     else if (is_all_queues_empty(scheduler) && scheduler->blocked_queue.size > 0) {
@@ -430,16 +1160,22 @@ void scheduler_step() {
             scheduler->blocked_queue.size);
     }
 
-    printf("[TRACE] ✅✅ END of scheduler_step (Clock: %d) | Ready: %d | Blocked: %d\n",
-           scheduler->clock_cycle,
-           !is_all_queues_empty(scheduler),
-           scheduler->blocked_queue.size);
-    print_scheduler_status(scheduler);
+    if (scheduler->verbose) {
+        printf("[TRACE] ✅✅ END of scheduler_step (Clock: %d) | Ready: %d | Blocked: %d\n",
+               scheduler->clock_cycle,
+               !is_all_queues_empty(scheduler),
+               scheduler->blocked_queue.size);
+        print_scheduler_status(scheduler);
+    }
+    event_emit(EVENT_CLOCK, scheduler->clock_cycle, 0, 0);
 }
 
 bool is_all_queues_empty(Scheduler* s) {
-    for (int i = 0; i < 4; i++) {
-        if (s->ready_queues[i].size > 0) return false;
+    for (int c = 0; c < s->num_cpus; c++) {
+        if (!cfs_is_empty(&s->cpus[c].cfs_queue)) return false;
+        for (int i = 0; i < 4; i++) {
+            if (s->cpus[c].ready_queues[i].size > 0) return false;
+        }
     }
     return true;
 }
@@ -447,24 +1183,71 @@ bool is_all_queues_empty(Scheduler* s) {
 
 void print_queues_state(Scheduler* scheduler) {
     printf("\n[TRACE] Queues pointer check:\n");
-    for (int i = 0; i < 4; i++) {
-        printf("  ready_queues[%d]: size=%d, capacity=%d, processes=%p\n",
-            i,
-            scheduler->ready_queues[i].size,
-            scheduler->ready_queues[i].capacity,
-            scheduler->ready_queues[i].processes);
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        for (int i = 0; i < 4; i++) {
+            printf("  cpu[%d].ready_queues[%d]: size=%d, capacity=%d, processes=%p\n",
+                c, i,
+                scheduler->cpus[c].ready_queues[i].size,
+                scheduler->cpus[c].ready_queues[i].capacity,
+                (void*)scheduler->cpus[c].ready_queues[i].processes);
+        }
     }
     printf("  blocked_queue: size=%d, capacity=%d, processes=%p\n",
         scheduler->blocked_queue.size,
         scheduler->blocked_queue.capacity,
-        scheduler->blocked_queue.processes);
+        (void*)scheduler->blocked_queue.processes);
 }
 
 bool is_in_blocked_queue(Scheduler* scheduler, PCB* pcb) {
-    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
-        if (scheduler->blocked_queue.processes[i] == pcb) {
-            return true;
+    int index = pcb->blocked_index;
+    return index >= 0 && index < scheduler->blocked_queue.size && scheduler->blocked_queue.processes[index] == pcb;
+}
+
+// The blocked queue is unordered: every PCB remembers its slot, and leaving moves
+// the last entry into it, so waking a process costs the same however many are blocked.
+// Callers hold scheduler_lock.
+void add_to_blocked_queue(Scheduler* scheduler, PCB* pcb) {
+    mark_queued(scheduler, pcb);
+    pcb->blocked_index = scheduler->blocked_queue.size;
+    add_to_queue(&scheduler->blocked_queue, pcb);
+}
+
+bool remove_from_blocked_queue(Scheduler* scheduler, PCB* pcb) {
+    if (!is_in_blocked_queue(scheduler, pcb)) return false;
+    ProcessQueue* blocked = &scheduler->blocked_queue;
+    PCB* last = blocked->processes[--blocked->size];
+    blocked->processes[pcb->blocked_index] = last;
+    last->blocked_index = pcb->blocked_index;
+    pcb->blocked_index = -1;
+    event_emit(EVENT_QUEUE, pcb->pid, 0, 0);
+    return true;
+}
+
+bool is_in_ready_queue(Scheduler* scheduler, PCB* pcb) {
+    (void)scheduler;
+    return pcb && pcb->queued_cpu >= 0;
+}
+
+// Look a process up by PID across running slots, ready, blocked and pending lists
+PCB* find_process(Scheduler* scheduler, int pid) {
+    if (!scheduler) return NULL;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        if (cpu->running_process && cpu->running_process->pid == pid) return cpu->running_process;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < cpu->ready_queues[i].size; j++) {
+                if (cpu->ready_queues[i].processes[j]->pid == pid) return cpu->ready_queues[i].processes[j];
+            }
+        }
+        for (PCB* pcb = cfs_peek(&cpu->cfs_queue); pcb; pcb = cfs_next(pcb)) {
+            if (pcb->pid == pid) return pcb;
         }
     }
-    return false;
-}
\ No newline at end of file
+    for (int i = 0; i < scheduler->blocked_queue.size; i++) {
+        if (scheduler->blocked_queue.processes[i]->pid == pid) return scheduler->blocked_queue.processes[i];
+    }
+    for (int i = 0; i < pending_list.count; i++) {
+        if (pending_list.list[i]->pid == pid) return pending_list.list[i];
+    }
+    return NULL;
+}
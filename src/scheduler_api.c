@@ -7,14 +7,32 @@
 #include <string.h>
 #include "globals.h"
 #include "interpreter.h"
+#include "input.h"
+#include "checkpoint.h"
+#include "whatif.h"
+#include "vfs.h"
+#include "aio.h"
+#include "device.h"
+#include "timer.h"
+#include "events.h"
+#include "program.h"
+#include "manifest.h"
 #include "queue.h"
-#include "scheduler.h"
 #include <stdlib.h>
+#include <time.h>
 
 static char process_list_buffer[2048];
 static char queue_state_buffer[2048];
 static char memory_state_buffer[2048];
 static char mutex_state_buffer[2048];
+static char cpu_state_buffer[MAX_CPUS * 128];
+static char metrics_buffer[1024];
+static char events_buffer[65536];
+static char file_stats_buffer[512];
+static char program_stats_buffer[256];
+static char device_stats_buffer[DEVICE_COUNT * 160];
+static char manifest_buffer[MANIFEST_MAX_ERRORS * 170 + 256];
+static char whatif_buffer[WHATIF_MAX_BRANCHES * 256];
 static char last_log[512] = "";  
 int already_initialized = 0;
 extern char purpose_msg[256];
@@ -47,6 +65,7 @@ void api_init_scheduler(SchedulingAlgorithm algorithm, int quantum) {
     }
     init_scheduler(scheduler, algorithm, quantum);
     init_memory(&memory);
+    destroy_resource_manager(&resource_manager);
     init_resource_manager(&resource_manager);
     scheduler_initialized = 1;
 
@@ -54,6 +73,193 @@ void api_init_scheduler(SchedulingAlgorithm algorithm, int quantum) {
     already_initialized = 1;
 }
 
+void api_set_cfs_params(int min_granularity, int target_latency) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_cfs_params!\n");
+        return;
+    }
+    set_cfs_params(scheduler, min_granularity, target_latency);
+}
+
+void api_set_cpu_count(int num_cpus) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_cpu_count!\n");
+        return;
+    }
+    set_cpu_count(scheduler, num_cpus);
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), "Simulating %d CPU(s).", scheduler->num_cpus);
+    log_event(&logger, log_msg);
+}
+
+void api_set_parallel(int enabled) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_parallel!\n");
+        return;
+    }
+    set_parallel_execution(scheduler, enabled);
+}
+
+void api_set_work_stealing(int enabled) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_work_stealing!\n");
+        return;
+    }
+    scheduler->work_stealing = enabled ? 1 : 0;
+}
+
+void api_set_event_driven(int enabled) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_event_driven!\n");
+        return;
+    }
+    set_event_driven(scheduler, enabled);
+}
+
+void api_set_verbose(int enabled) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_verbose!\n");
+        return;
+    }
+    set_verbose_output(scheduler, enabled);
+}
+
+void api_set_boost_period(int cycles) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_boost_period!\n");
+        return;
+    }
+    set_boost_period(scheduler, cycles);
+}
+
+void api_set_aging_threshold(int level, int cycles) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_aging_threshold!\n");
+        return;
+    }
+    set_aging_threshold(scheduler, level, cycles);
+}
+
+void api_set_starvation_threshold(int cycles) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_starvation_threshold!\n");
+        return;
+    }
+    set_starvation_threshold(scheduler, cycles);
+}
+
+void api_set_instructions_per_cycle(int count) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside api_set_instructions_per_cycle!\n");
+        return;
+    }
+    set_instructions_per_cycle(scheduler, count);
+}
+
+// 0 = report only, 1 = abort the youngest process, 2 = preempt its resources
+void api_set_deadlock_policy(int policy) {
+    if (policy < DEADLOCK_REPORT_ONLY || policy > DEADLOCK_PREEMPT) {
+        printf("[ERROR] api_set_deadlock_policy: unknown policy %d\n", policy);
+        return;
+    }
+    resource_manager.deadlock_policy = (DeadlockPolicy)policy;
+}
+
+void api_set_priority_inheritance(int enabled) {
+    resource_manager.priority_inheritance = enabled ? 1 : 0;
+}
+
+const char* get_deadlock_report() {
+    return get_last_deadlock_report();
+}
+
+int set_process_affinity(int pid, unsigned long long mask) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside set_process_affinity!\n");
+        return -1;
+    }
+    PCB* pcb = find_process(scheduler, pid);
+    if (!pcb) {
+        printf("[ERROR] set_process_affinity: no process with PID %d\n", pid);
+        return -1;
+    }
+    set_pcb_affinity(pcb, (uint64_t)mask);
+    return 0;
+}
+
+// One line per CPU: running PID, queued work, utilization, migrations and steals
+const char* get_cpu_state() {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside get_cpu_state!\n");
+        return "SCHEDULER_NULL";
+    }
+    memset(cpu_state_buffer, 0, sizeof(cpu_state_buffer));
+
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        long long total = cpu->busy_cycles + cpu->idle_cycles;
+        double utilization = total > 0 ? 100.0 * cpu->busy_cycles / total : 0.0;
+        char line[192];
+        snprintf(line, sizeof(line),
+            "CPU%d: running=%d, queued=%d, utilization=%.1f%%, dispatches=%d, migrations=%d, steals=%d\n",
+            c,
+            cpu->running_process ? cpu->running_process->pid : -1,
+            cpu_load(cpu) - (cpu->running_process ? 1 : 0),
+            utilization,
+            cpu->dispatches,
+            cpu->migrations,
+            cpu->steals);
+        if (strlen(cpu_state_buffer) + strlen(line) + 1 >= sizeof(cpu_state_buffer)) break;
+        strncat(cpu_state_buffer, line, sizeof(cpu_state_buffer) - strlen(cpu_state_buffer) - 1);
+    }
+
+    return cpu_state_buffer;
+}
+
+// Scheduler-wide counters as "key=value" lines
+const char* get_metrics() {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside get_metrics!\n");
+        return "SCHEDULER_NULL";
+    }
+    const SchedulerMetrics* m = &scheduler->metrics;
+    double avg_wait = m->dispatches > 0 ? (double)m->total_ready_wait / m->dispatches : 0.0;
+    snprintf(metrics_buffer, sizeof(metrics_buffer),
+        "clock=%d\n"
+        "dispatches=%lld\n"
+        "avg_ready_wait=%.2f\n"
+        "max_ready_wait=%d\n"
+        "max_ready_wait_pid=%d\n"
+        "starvation_alarms=%lld\n"
+        "boosts=%lld\n"
+        "promotions=%lld\n"
+        "demotions=%lld\n"
+        "deadlocks=%lld\n"
+        "deadlock_recoveries=%lld\n"
+        "inheritance_boosts=%lld\n"
+        "inversion_cycles=%lld\n"
+        "idle_cycles=%lld\n"
+        "skipped_cycles=%lld\n"
+        "timeouts=%lld\n",
+        scheduler->clock_cycle,
+        m->dispatches,
+        avg_wait,
+        m->max_ready_wait,
+        m->max_ready_wait > 0 ? m->max_ready_wait_pid : -1,
+        m->starvation_alarms,
+        m->boosts,
+        m->promotions,
+        m->demotions,
+        m->deadlocks,
+        m->deadlock_recoveries,
+        m->inheritance_boosts,
+        m->inversion_cycles,
+        m->idle_cycles,
+        m->skipped_cycles,
+        m->timeouts);
+    return metrics_buffer;
+}
+
 const char* get_process_list() {
     printf("[DEBUG] get_process_list: scheduler=%p\n", scheduler);
     if (scheduler == NULL) {
@@ -62,11 +268,29 @@ const char* get_process_list() {
     }
     memset(process_list_buffer, 0, sizeof(process_list_buffer));
 
-    //  Ready queues 
-    for (int lvl = 0; lvl < 4; lvl++) {
-        ProcessQueue* queue = &scheduler->ready_queues[lvl];
-        for (int i = 0; i < queue->size; i++) {
-            PCB* pcb = queue->processes[i];
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+
+        //  Ready queues 
+        for (int lvl = 0; lvl < 4; lvl++) {
+            ProcessQueue* queue = &cpu->ready_queues[lvl];
+            for (int i = 0; i < queue->size; i++) {
+                PCB* pcb = queue->processes[i];
+                char line[128];
+                snprintf(line, sizeof(line), "%d,%s,%d,%d-%d,%d\n",
+                    pcb->pid,
+                    get_state_string(pcb->state),
+                    pcb->priority,
+                    pcb->memory_lower_bound, pcb->memory_upper_bound,
+                    pcb->program_counter);
+                if (strlen(process_list_buffer) + strlen(line) + 1 < sizeof(process_list_buffer)) {
+                    strncat(process_list_buffer, line, sizeof(process_list_buffer) - strlen(process_list_buffer) - 1);
+                }
+            }
+        }
+
+        //  CFS run queue (in vruntime order)
+        for (PCB* pcb = cfs_peek(&cpu->cfs_queue); pcb; pcb = cfs_next(pcb)) {
             char line[128];
             snprintf(line, sizeof(line), "%d,%s,%d,%d-%d,%d\n",
                 pcb->pid,
@@ -74,9 +298,8 @@ const char* get_process_list() {
                 pcb->priority,
                 pcb->memory_lower_bound, pcb->memory_upper_bound,
                 pcb->program_counter);
-            if (strlen(process_list_buffer) + strlen(line) + 1 < sizeof(process_list_buffer)) {
-                strncat(process_list_buffer, line, sizeof(process_list_buffer) - strlen(process_list_buffer) - 1);
-            }
+            if (strlen(process_list_buffer) + strlen(line) + 1 >= sizeof(process_list_buffer)) break;
+            strncat(process_list_buffer, line, sizeof(process_list_buffer) - strlen(process_list_buffer) - 1);
         }
     }
 
@@ -96,16 +319,26 @@ const char* get_process_list() {
         }
     }
 
-    //  Running process
-    if (scheduler->running_process) {
-        PCB* pcb = scheduler->running_process;
+    //  Running processes
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        PCB* pcb = scheduler->cpus[c].running_process;
+        if (!pcb) continue;
         char line[128];
-        snprintf(line, sizeof(line), "%d,%s,%d,%d-%d,%d (RUNNING)\n",
-            pcb->pid,
-            get_state_string(pcb->state),
-            pcb->priority,
-            pcb->memory_lower_bound, pcb->memory_upper_bound,
-            pcb->program_counter);
+        if (scheduler->num_cpus > 1) {
+            snprintf(line, sizeof(line), "%d,%s,%d,%d-%d,%d (RUNNING on CPU %d)\n",
+                pcb->pid,
+                get_state_string(pcb->state),
+                pcb->priority,
+                pcb->memory_lower_bound, pcb->memory_upper_bound,
+                pcb->program_counter, c);
+        } else {
+            snprintf(line, sizeof(line), "%d,%s,%d,%d-%d,%d (RUNNING)\n",
+                pcb->pid,
+                get_state_string(pcb->state),
+                pcb->priority,
+                pcb->memory_lower_bound, pcb->memory_upper_bound,
+                pcb->program_counter);
+        }
         if (strlen(process_list_buffer) + strlen(line) + 1 < sizeof(process_list_buffer)) {
             strncat(process_list_buffer, line, sizeof(process_list_buffer) - strlen(process_list_buffer) - 1);
         }
@@ -137,18 +370,33 @@ const char* get_queue_state() {
     }
     memset(queue_state_buffer, 0, sizeof(queue_state_buffer));
 
-    for (int lvl = 0; lvl < 4; lvl++) {
-        ProcessQueue* queue = &scheduler->ready_queues[lvl];
-        for (int i = 0; i < queue->size; i++) {
-            PCB* pcb = queue->processes[i];
-            char line[128];
-            snprintf(line, sizeof(line), "ReadyQ%d: %d,%d,%d\n",
-                lvl,
-                pcb->pid, pcb->program_counter, pcb->time_in_queue);
-            if (strlen(queue_state_buffer) + strlen(line) + 1 < sizeof(queue_state_buffer)) {
-                strncat(queue_state_buffer, line, sizeof(queue_state_buffer) - strlen(queue_state_buffer) - 1);
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        Cpu* cpu = &scheduler->cpus[c];
+        // Single-CPU output keeps the original "ReadyQn:" labels
+        char prefix[16] = "";
+        if (scheduler->num_cpus > 1) snprintf(prefix, sizeof(prefix), "CPU%d ", c);
+
+        for (int lvl = 0; lvl < 4; lvl++) {
+            ProcessQueue* queue = &cpu->ready_queues[lvl];
+            for (int i = 0; i < queue->size; i++) {
+                PCB* pcb = queue->processes[i];
+                char line[128];
+                snprintf(line, sizeof(line), "%sReadyQ%d: %d,%d,%d\n",
+                    prefix, lvl,
+                    pcb->pid, pcb->program_counter, pcb_time_in_queue(scheduler, pcb));
+                if (strlen(queue_state_buffer) + strlen(line) + 1 < sizeof(queue_state_buffer)) {
+                    strncat(queue_state_buffer, line, sizeof(queue_state_buffer) - strlen(queue_state_buffer) - 1);
+                }
             }
         }
+
+        for (PCB* pcb = cfs_peek(&cpu->cfs_queue); pcb; pcb = cfs_next(pcb)) {
+            char line[128];
+            snprintf(line, sizeof(line), "%sCFS: %d,%d,%lld\n",
+                prefix, pcb->pid, pcb->program_counter, pcb->vruntime);
+            if (strlen(queue_state_buffer) + strlen(line) + 1 >= sizeof(queue_state_buffer)) break;
+            strncat(queue_state_buffer, line, sizeof(queue_state_buffer) - strlen(queue_state_buffer) - 1);
+        }
     }
 
     ProcessQueue* blocked = &scheduler->blocked_queue;
@@ -156,7 +404,7 @@ const char* get_queue_state() {
         PCB* pcb = blocked->processes[i];
         char line[128];
         snprintf(line, sizeof(line), "Blocked: %d,%d,%d\n",
-            pcb->pid, pcb->program_counter, pcb->time_in_queue);
+            pcb->pid, pcb->program_counter, pcb_time_in_queue(scheduler, pcb));
         if (strlen(queue_state_buffer) + strlen(line) + 1 < sizeof(queue_state_buffer)) {
             strncat(queue_state_buffer, line, sizeof(queue_state_buffer) - strlen(queue_state_buffer) - 1);
         }
@@ -173,6 +421,13 @@ const char* get_memory_state() {
     }
     memset(memory_state_buffer, 0, sizeof(memory_state_buffer));
 
+    // The summary goes last, so keep room for it however long the words get
+    MemoryUsage usage = get_memory_usage(&memory);
+    char summary[160];
+    snprintf(summary, sizeof(summary), "Shared: %d word(s) in %d text segment(s) | Private: %d word(s) | Free: %d word(s)\n",
+        usage.shared, usage.segments, usage.private_words, usage.free_words);
+    size_t limit = sizeof(memory_state_buffer) - strlen(summary);
+
     for (int i = 0; i < MEMORY_SIZE; i++) {
         char* name = NULL;
         char* data = NULL;
@@ -181,16 +436,22 @@ const char* get_memory_state() {
 
         char line[256];  
 
-        if (data != NULL && pid > 0) {
+        if (data != NULL && pid == MEMORY_SHARED_PID) {
+            const TextSegment* segment = find_text_segment(&memory, i);
+            snprintf(line, sizeof(line), "%d: %s (SHARED x%d)\n", i, data, segment ? segment->refs : 0);
+        } else if (data != NULL && pid > 0) {
             snprintf(line, sizeof(line), "%d: %s (PID=%d)\n", i, data, pid);
+        } else if (pid > 0) {
+            snprintf(line, sizeof(line), "%d: RESERVED (PID=%d)\n", i, pid);
         } else {
             snprintf(line, sizeof(line), "%d: EMPTY (PID=0)\n", i);  
         }
 
-        if (strlen(memory_state_buffer) + strlen(line) + 1 < sizeof(memory_state_buffer)) {
+        if (strlen(memory_state_buffer) + strlen(line) + 1 < limit) {
             strncat(memory_state_buffer, line, sizeof(memory_state_buffer) - strlen(memory_state_buffer) - 1);
         }
     }
+    strncat(memory_state_buffer, summary, sizeof(memory_state_buffer) - strlen(memory_state_buffer) - 1);
 
     return memory_state_buffer;
 }
@@ -203,13 +464,22 @@ const char* get_mutex_state() {
     }
     memset(mutex_state_buffer, 0, sizeof(mutex_state_buffer));
 
-    snprintf(mutex_state_buffer, sizeof(mutex_state_buffer),
-        "UserInput: held_by=%d, waiting=%d\n"
-        "UserOutput: held_by=%d, waiting=%d\n"
-        "File: held_by=%d, waiting=%d\n",
-        resource_manager.mutexes[RESOURCE_USER_INPUT].owner_pid, resource_manager.mutexes[RESOURCE_USER_INPUT].queue_size,
-        resource_manager.mutexes[RESOURCE_USER_OUTPUT].owner_pid, resource_manager.mutexes[RESOURCE_USER_OUTPUT].queue_size,
-        resource_manager.mutexes[RESOURCE_FILE].owner_pid, resource_manager.mutexes[RESOURCE_FILE].queue_size);
+    // Built-ins keep their original labels; declared semaphores use their program names
+    static const char* builtin_labels[NUM_BUILTIN_RESOURCES] = {"UserInput", "UserOutput", "File"};
+    for (int id = 0; id < resource_manager.count; id++) {
+        const Mutex* mutex = &resource_manager.mutexes[id];
+        char holders[128] = "-1";
+        int used = 0;
+        for (int h = 0; h < mutex->holder_count && used < (int)sizeof(holders) - 12; h++) {
+            used += snprintf(holders + used, sizeof(holders) - used, h ? " %d" : "%d", mutex->holders[h]->pid);
+        }
+        char line[256];
+        snprintf(line, sizeof(line), "%s: held_by=%s, waiting=%d, available=%d/%d\n",
+            id < NUM_BUILTIN_RESOURCES ? builtin_labels[id] : mutex->name,
+            holders, mutex->queue_size, mutex->available, mutex->initial_count);
+        if (strlen(mutex_state_buffer) + strlen(line) + 1 >= sizeof(mutex_state_buffer)) break;
+        strncat(mutex_state_buffer, line, sizeof(mutex_state_buffer) - strlen(mutex_state_buffer) - 1);
+    }
 
     return mutex_state_buffer;
 }
@@ -225,16 +495,51 @@ void reset_scheduler() {
         printf("[FATAL] scheduler is NULL inside reset_scheduler before init_scheduler!\n");
         return;
     }
+    // Tunables survive a reset; queues, clock and metrics do not
+    int num_cpus = scheduler->num_cpus;
+    int work_stealing = scheduler->work_stealing;
+    int parallel = scheduler->parallel;
+    int event_driven = scheduler->event_driven;
+    int verbose = scheduler->verbose;
+    int min_granularity = scheduler->min_granularity;
+    int target_latency = scheduler->target_latency;
+    int boost_period = scheduler->boost_period;
+    int starvation_threshold = scheduler->starvation_threshold;
+    int instructions_per_cycle = scheduler->instructions_per_cycle;
+    int aging_threshold[4];
+    memcpy(aging_threshold, scheduler->aging_threshold, sizeof(aging_threshold));
     init_scheduler(scheduler, scheduler->algorithm, scheduler->quantum);
+    set_cpu_count(scheduler, num_cpus);
+    scheduler->work_stealing = work_stealing;
+    scheduler->parallel = parallel;   // the CPU threads restart on the next parallel cycle
+    scheduler->event_driven = event_driven;
+    scheduler->verbose = verbose;
+    scheduler->min_granularity = min_granularity;
+    scheduler->target_latency = target_latency;
+    scheduler->boost_period = boost_period;
+    scheduler->starvation_threshold = starvation_threshold;
+    scheduler->instructions_per_cycle = instructions_per_cycle;
+    memcpy(scheduler->aging_threshold, aging_threshold, sizeof(aging_threshold));
     if (scheduler == NULL) {
         printf("[FATAL] scheduler is NULL inside reset_scheduler before print_queues_state!\n");
         return;
     }
     print_queues_state(scheduler);
     init_memory(&memory);
+    DeadlockPolicy deadlock_policy = resource_manager.deadlock_policy;
+    int priority_inheritance = resource_manager.priority_inheritance;
+    destroy_resource_manager(&resource_manager);
     init_resource_manager(&resource_manager);
+    resource_manager.deadlock_policy = deadlock_policy;
+    resource_manager.priority_inheritance = priority_inheritance;
+    input_reset();
+    aio_reset();
+    device_reset();
+    timer_reset(0);
+    vfs_reset();
     set_last_log("Scheduler reset.");
     already_initialized = 0;
+    event_emit(EVENT_RESET, 0, 0, 0);
 }
 
 void step_execution() {
@@ -259,50 +564,64 @@ int get_total_processes() {
         return -1;
     }
     int total = 0;
-    for (int lvl = 0; lvl < 4; lvl++) {
-        total += scheduler->ready_queues[lvl].size;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        total += cpu_load(&scheduler->cpus[c]);
     }
     total += scheduler->blocked_queue.size;
-    if (scheduler->running_process != NULL) total++;
     return total;
 }
 
-const char* get_algorithm_name() {
-    if (scheduler == NULL) {
-        printf("[FATAL] scheduler is NULL inside get_algorithm_name!\n");
-        return "SCHEDULER_NULL";
-    }
-    switch (scheduler->algorithm) {
+static const char* algorithm_name(SchedulingAlgorithm algorithm) {
+    switch (algorithm) {
         case FCFS: return "FCFS";
         case RR: return "Round Robin";
         case MLFQ: return "MLFQ";
+        case CFS: return "CFS";
         default: return "Unknown";
     }
 }
 
-int load_process_from_file(const char* path, int arrival_time) {  
+const char* get_algorithm_name() {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside get_algorithm_name!\n");
+        return "SCHEDULER_NULL";
+    }
+    return algorithm_name(scheduler->algorithm);
+}
+
+// Create a process for the program at path and queue it for its arrival; NULL on failure
+static PCB* spawn_process(const char* path, int arrival_time) {
     PCB* pcb = create_pcb(next_pid++, arrival_time);
 
     const char* filename = strrchr(path, '/');
     if (filename) filename++; else filename = path;
-    strncpy(pcb->program_name, filename, sizeof(pcb->program_name));
+    strncpy(pcb->program_name, filename, sizeof(pcb->program_name) - 1);
 
     if (!load_program(&memory, pcb, path)) {
         printf("Failed to load program from %s\n", path);
         destroy_pcb(pcb);
-        set_last_log("Failed to load process.");  
-        return -1;
+        return NULL;
     }
 
     if (pcb->priority < 1) {
-        pcb->priority = 1;
+        set_pcb_priority(pcb, 1);
     }
 
     printf("Process loaded from %s (PID: %d)\n", path, pcb->pid);
-    pending_list.list[pending_list.count++] = pcb;
+    add_pending_process(pcb);
     already_initialized = 1;
+    return pcb;
+}
 
-    char log_msg[256];
+int load_process_from_file(const char* path, int arrival_time) {  
+    PCB* pcb = spawn_process(path, arrival_time);
+    if (!pcb) {
+        set_last_log("Failed to load process.");  
+        return -1;
+    }
+    const char* filename = pcb->program_name;
+
+    char log_msg[MAX_PROGRAM_NAME_LENGTH + 64];
     snprintf(log_msg, sizeof(log_msg), "Loaded process from %s (PID: %d)", filename, pcb->pid); 
     set_last_log(log_msg);
     return pcb->pid;
@@ -314,4 +633,340 @@ int has_pending_processes() {
 
 const char* get_purpose_msg() {
     return purpose_msg;
-}
\ No newline at end of file
+}
+
+// Answer a specific process's pending `assign x input`; -1 if it is not waiting
+int answer_input(int pid, const char* value) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside answer_input!\n");
+        return -1;
+    }
+    return input_answer(pid, value);
+}
+
+const char* get_input_requests() {
+    return input_pending_requests();
+}
+
+// Feed inputs from a file ("-" = stdin) so batch runs never wait on a human
+int load_input_script(const char* path) {
+    return input_load_script(path);
+}
+
+void add_scripted_input(const char* value) {
+    input_add_scripted_answer(value);
+}
+
+int save_checkpoint(const char* path) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside save_checkpoint!\n");
+        return -1;
+    }
+    // PIDs are handed out here, not by the scheduler
+    scheduler->next_pid = next_pid;
+    if (checkpoint_save(scheduler, path) != 0) return -1;
+    char log_msg[512];
+    snprintf(log_msg, sizeof(log_msg), "Checkpoint saved to %s at clock %d.", path, scheduler->clock_cycle);
+    log_event(&logger, log_msg);
+    return 0;
+}
+
+int load_checkpoint(const char* path) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside load_checkpoint!\n");
+        return -1;
+    }
+    if (checkpoint_load(scheduler, path) != 0) return -1;
+    next_pid = scheduler->next_pid;
+    already_initialized = 1;
+    char log_msg[512];
+    snprintf(log_msg, sizeof(log_msg), "Checkpoint restored from %s at clock %d.", path, scheduler->clock_cycle);
+    log_event(&logger, log_msg);
+    set_last_log(log_msg);
+    event_emit(EVENT_RESET, scheduler->clock_cycle, 0, 0);
+    return 0;
+}
+
+// "FCFS", "RR", "MLFQ", "CFS" or the enum value; "-" keeps the current policy
+static int parse_algorithm(const char* token) {
+    if (strcmp(token, "FCFS") == 0) return FCFS;
+    if (strcmp(token, "RR") == 0) return RR;
+    if (strcmp(token, "MLFQ") == 0) return MLFQ;
+    if (strcmp(token, "CFS") == 0) return CFS;
+    if (strcmp(token, "-") == 0) return -1;
+    char* end;
+    long value = strtol(token, &end, 10);
+    return (*end == '\0' && value >= FCFS && value <= CFS) ? (int)value : -2;
+}
+
+// Fork the simulation into branches and run each to completion (or max_cycles).
+// spec is ';'-separated branches of "<algorithm> [quantum] [input-script]",
+// e.g. "MLFQ 2;RR 4 answers.txt;CFS". Returns one line of results per branch.
+const char* run_what_if(const char* spec, int max_cycles) {
+    whatif_buffer[0] = '\0';
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside run_what_if!\n");
+        return whatif_buffer;
+    }
+    if (!spec) return whatif_buffer;
+
+    WhatIfBranch branches[WHATIF_MAX_BRANCHES];
+    WhatIfResult results[WHATIF_MAX_BRANCHES];
+    int count = 0;
+    char spec_copy[2048];
+    snprintf(spec_copy, sizeof(spec_copy), "%s", spec);
+    char* branch_save = NULL;
+    for (char* part = strtok_r(spec_copy, ";", &branch_save); part && count < WHATIF_MAX_BRANCHES;
+         part = strtok_r(NULL, ";", &branch_save)) {
+        char* token_save = NULL;
+        char* algorithm = strtok_r(part, " \t", &token_save);
+        if (!algorithm) continue;
+        WhatIfBranch* branch = &branches[count];
+        memset(branch, 0, sizeof(*branch));
+        branch->algorithm = parse_algorithm(algorithm);
+        if (branch->algorithm == -2) {
+            printf("[WARN] Unknown algorithm [%s] in what-if spec; branch skipped\n", algorithm);
+            continue;
+        }
+        char* quantum = strtok_r(NULL, " \t", &token_save);
+        if (quantum) branch->quantum = atoi(quantum);
+        char* script = strtok_r(NULL, " \t", &token_save);
+        if (script) snprintf(branch->input_script, sizeof(branch->input_script), "%s", script);
+        branch->max_cycles = max_cycles;
+        count++;
+    }
+
+    whatif_run(scheduler, branches, count, results);
+
+    int offset = 0;
+    for (int b = 0; b < count; b++) {
+        SchedulingAlgorithm algorithm = branches[b].algorithm >= 0 ? (SchedulingAlgorithm)branches[b].algorithm : scheduler->algorithm;
+        int quantum = branches[b].quantum > 0 ? branches[b].quantum : scheduler->quantum;
+        int written;
+        if (!results[b].ok) {
+            written = snprintf(whatif_buffer + offset, sizeof(whatif_buffer) - offset,
+                "branch=%d algorithm=%s quantum=%d failed=1\n", b, algorithm_name(algorithm), quantum);
+        } else {
+            const SchedulerMetrics* m = &results[b].metrics;
+            double avg_wait = m->dispatches > 0 ? (double)m->total_ready_wait / m->dispatches : 0.0;
+            written = snprintf(whatif_buffer + offset, sizeof(whatif_buffer) - offset,
+                "branch=%d algorithm=%s quantum=%d clock=%d finished=%d remaining=%d "
+                "dispatches=%lld avg_ready_wait=%.2f max_ready_wait=%d demotions=%lld deadlocks=%lld idle_cycles=%lld\n",
+                b, algorithm_name(algorithm), quantum, results[b].clock_cycle, results[b].finished,
+                results[b].remaining, m->dispatches, avg_wait, m->max_ready_wait, m->demotions,
+                m->deadlocks, m->idle_cycles);
+        }
+        if (written < 0 || written >= (int)sizeof(whatif_buffer) - offset) break;
+        offset += written;
+    }
+    return whatif_buffer;
+}
+
+// 0 = write-through, 1 = write-back, 2 = in-memory only (see VfsMode)
+void api_set_file_mode(int mode) {
+    if (mode < VFS_WRITE_THROUGH || mode > VFS_MEMORY) {
+        printf("[WARN] Unknown file mode %d\n", mode);
+        return;
+    }
+    vfs_set_mode((VfsMode)mode);
+    static const char* labels[] = {"write-through", "write-back", "in-memory"};
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), "File layer mode: %s.", labels[mode]);
+    log_event(&logger, log_msg);
+}
+
+int flush_files() {
+    return vfs_flush();
+}
+
+const char* get_file_stats() {
+    VfsStats stats = vfs_get_stats();
+    snprintf(file_stats_buffer, sizeof(file_stats_buffer),
+        "mode=%d\nreads=%lld\nwrites=%lld\ncache_hits=%lld\ndisk_reads=%lld\ndisk_writes=%lld\nopens=%lld\n",
+        vfs_get_mode(), stats.reads, stats.writes, stats.cache_hits,
+        stats.disk_reads, stats.disk_writes, stats.opens);
+    return file_stats_buffer;
+}
+
+// readFile/writeFile block the process for latency_cycles while an I/O thread does the work
+void api_set_async_io(int enabled, int latency_cycles) {
+    if (latency_cycles > 0) aio_set_latency(latency_cycles);
+    aio_set_enabled(enabled != 0);
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), "Asynchronous file I/O %s.", enabled ? "enabled" : "disabled");
+    log_event(&logger, log_msg);
+}
+
+// Cycles an instruction occupies the CPU, by mnemonic ("print", "add", "writeFile", ...).
+// Returns 0, or -1 if the mnemonic is unknown.
+int api_set_instruction_cost(const char* mnemonic, int cycles) {
+    InstructionType type = parse_instruction(mnemonic);
+    if (!mnemonic || type == INSTR_UNKNOWN || strcspn(mnemonic, " \t") != strlen(mnemonic)) {
+        printf("[ERROR] Unknown instruction '%s' for a cost\n", mnemonic ? mnemonic : "(null)");
+        return -1;
+    }
+    set_instruction_cost(type, cycles);
+    printf("[SCHED] %s costs %d cycle(s)\n", mnemonic, instruction_cost(type));
+    return 0;
+}
+
+// Service time of "disk" or "console" in cycles; 0 makes the device instantaneous.
+// Returns 0, or -1 if there is no such device.
+int api_set_device_service_time(const char* device, int cycles) {
+    DeviceId id = device_by_name(device);
+    if (id == DEVICE_COUNT) {
+        printf("[ERROR] Unknown device '%s'\n", device ? device : "(null)");
+        return -1;
+    }
+    device_set_service_time(id, cycles);
+    char log_msg[128];
+    snprintf(log_msg, sizeof(log_msg), "Device %s service time set to %d cycle(s).", device_name(id), cycles > 0 ? cycles : 0);
+    log_event(&logger, log_msg);
+    return 0;
+}
+
+// One line per device: service time, operations, utilization and queueing
+const char* get_device_stats() {
+    Device devices[DEVICE_COUNT];
+    device_snapshot(devices);
+    int clock = scheduler ? scheduler->clock_cycle : 0;
+    size_t used = 0;
+    device_stats_buffer[0] = '\0';
+    for (int i = 0; i < DEVICE_COUNT && used < sizeof(device_stats_buffer); i++) {
+        const Device* device = &devices[i];
+        double utilization = clock > 0 ? 100.0 * device->busy_cycles / clock : 0.0;
+        if (utilization > 100.0) utilization = 100.0;   // the last operation may finish after now
+        double avg_queue = device->operations > 0 ? (double)device->queue_cycles / device->operations : 0.0;
+        used += snprintf(device_stats_buffer + used, sizeof(device_stats_buffer) - used,
+            "%s: service=%d operations=%lld busy=%lld utilization=%.1f%% avg_queue_wait=%.2f max_queue=%d\n",
+            device_name((DeviceId)i), device->service_time, device->operations, device->busy_cycles,
+            utilization, avg_queue, device->max_queue);
+    }
+    return device_stats_buffer;
+}
+
+const char* get_program_cache_stats() {
+    ProgramCacheStats stats = program_cache_stats();
+    snprintf(program_stats_buffer, sizeof(program_stats_buffer),
+        "loads=%lld\nparses=%lld\ncached=%d\n", stats.loads, stats.parses, stats.cached);
+    return program_stats_buffer;
+}
+
+static double elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+// Load every process listed in a workload manifest (see manifest.h for the format).
+// Reports the PID range, counts, load time and per-line errors.
+const char* load_manifest(const char* path) {
+    if (scheduler == NULL) {
+        printf("[FATAL] scheduler is NULL inside load_manifest!\n");
+        return "SCHEDULER_NULL";
+    }
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    Manifest manifest;
+    if (!path || manifest_parse(path, &manifest) < 0) {
+        snprintf(manifest_buffer, sizeof(manifest_buffer), "error=cannot open manifest %s\n", path ? path : "(null)");
+        set_last_log("Failed to open manifest.");
+        return manifest_buffer;
+    }
+
+    int first_pid = -1, last_pid = -1, loaded = 0, failed = 0;
+    for (int e = 0; e < manifest.count; e++) {
+        const ManifestEntry* entry = &manifest.entries[e];
+        // One cache lookup up front tells a bad path apart from running out of memory
+        Program* program = program_load(entry->path);
+        if (!program) {
+            manifest_error(&manifest, entry->line, "cannot read %s", entry->path);
+            failed += entry->repeat;
+            continue;
+        }
+        int entry_failed = 0;
+        for (int r = 0; r < entry->repeat; r++) {
+            int pid = next_pid;
+            PCB* pcb = spawn_process(entry->path, entry->arrival);
+            if (!pcb) {
+                // Keep the PID range contiguous
+                next_pid = pid;
+                entry_failed = entry->repeat - r;
+                break;
+            }
+            if (entry->priority > 0) set_pcb_priority(pcb, entry->priority);
+            if (entry->has_nice) set_pcb_nice(pcb, entry->nice);
+            if (first_pid < 0) first_pid = pcb->pid;
+            last_pid = pcb->pid;
+            loaded++;
+        }
+        program_release(program);
+        if (entry_failed > 0) {
+            manifest_error(&manifest, entry->line, "%d of %d instance(s) of %s not loaded (out of memory)",
+                entry_failed, entry->repeat, entry->path);
+            failed += entry_failed;
+        }
+    }
+    double load_ms = elapsed_ms(&start);
+
+    int length = snprintf(manifest_buffer, sizeof(manifest_buffer),
+        "first_pid=%d\nlast_pid=%d\nloaded=%d\nfailed=%d\nentries=%d\nload_ms=%.3f\nerrors=%d\n",
+        first_pid, last_pid, loaded, failed, manifest.count, load_ms, manifest.error_count);
+    int kept = manifest.error_count < MANIFEST_MAX_ERRORS ? manifest.error_count : MANIFEST_MAX_ERRORS;
+    for (int i = 0; i < kept && length < (int)sizeof(manifest_buffer); i++) {
+        length += snprintf(manifest_buffer + length, sizeof(manifest_buffer) - length, "%s\n", manifest.errors[i]);
+    }
+    if (manifest.error_count > kept && length < (int)sizeof(manifest_buffer)) {
+        snprintf(manifest_buffer + length, sizeof(manifest_buffer) - length, "... %d more\n", manifest.error_count - kept);
+    }
+    manifest_free(&manifest);
+
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "Loaded %d process(es) from manifest in %.1f ms (%d failed).", loaded, load_ms, failed);
+    set_last_log(log_msg);
+    log_event(&logger, log_msg);
+    return manifest_buffer;
+}
+
+// Call callback for every event whose type is in mask (EVENT_MASK bits, see events.h).
+// It runs on the simulator's own threads and must not call back into this API.
+// Returns an id for unsubscribe_events, or -1.
+int subscribe_events(unsigned mask, EventCallback callback, void* user_data) {
+    return events_subscribe(mask, callback, user_data);
+}
+
+void unsubscribe_events(int id) {
+    events_unsubscribe(id);
+}
+
+// Queue the event types in mask for poll_events/get_events; 0 stops queueing
+void api_set_event_queue(unsigned mask) {
+    events_set_queue_mask(mask);
+    printf("[SCHED] Event queue mask 0x%x\n", mask & EVENT_MASK_ALL);
+}
+
+int poll_events(SchedulerEvent* out, int max) {
+    return events_poll(out, max);
+}
+
+// Readable while queued events are waiting (Linux eventfd), -1 if unavailable
+int get_event_fd() {
+    return events_fd();
+}
+
+// Drain up to max queued events (0 = as many as fit), one per line:
+// "type,cycle,a,b,c" and, for log events, ",text"
+const char* get_events(int max) {
+    int length = 0;
+    events_buffer[0] = '\0';
+    SchedulerEvent event;
+    for (int n = 0; max <= 0 || n < max; n++) {
+        if ((int)sizeof(events_buffer) - length < MAX_LOG_LENGTH + 64) break;
+        if (events_poll(&event, 1) == 0) break;
+        length += snprintf(events_buffer + length, sizeof(events_buffer) - length, "%s,%d,%d,%d,%d%s%s\n",
+            event_type_name((EventType)event.type), event.cycle, event.a, event.b, event.c,
+            event.type == EVENT_LOG ? "," : "", event.type == EVENT_LOG ? event.text : "");
+    }
+    return events_buffer;
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <pthread.h>
+#include "smp.h"
+
+// Reusable barrier (pthread_barrier_t is not available on macOS)
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;
+    int waiting;
+    unsigned generation;
+} CycleBarrier;
+
+typedef struct {
+    Scheduler* scheduler;
+    int cpu_id;
+    int executed;
+    pthread_t thread;
+} SmpWorker;
+
+// The calling thread runs CPU 0 itself; workers[i] runs CPU i + 1
+static SmpWorker workers[MAX_CPUS - 1];
+static int worker_count = 0;
+static Scheduler* worker_scheduler = NULL;
+static int stop_requested = 0;
+static CycleBarrier start_barrier;
+static CycleBarrier done_barrier;
+
+static void barrier_init(CycleBarrier* barrier, int count) {
+    pthread_mutex_init(&barrier->mutex, NULL);
+    pthread_cond_init(&barrier->cond, NULL);
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->generation = 0;
+}
+
+static void barrier_destroy(CycleBarrier* barrier) {
+    pthread_mutex_destroy(&barrier->mutex);
+    pthread_cond_destroy(&barrier->cond);
+}
+
+static void barrier_wait(CycleBarrier* barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    unsigned generation = barrier->generation;
+    if (++barrier->waiting == barrier->count) {
+        barrier->waiting = 0;
+        barrier->generation++;
+        pthread_cond_broadcast(&barrier->cond);
+    } else {
+        while (generation == barrier->generation) {
+            pthread_cond_wait(&barrier->cond, &barrier->mutex);
+        }
+    }
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+static void* worker_main(void* arg) {
+    SmpWorker* worker = (SmpWorker*)arg;
+    for (;;) {
+        barrier_wait(&start_barrier);
+        if (stop_requested) break;
+        Cpu* cpu = &worker->scheduler->cpus[worker->cpu_id];
+        worker->executed = cpu_step(worker->scheduler, cpu) ? 1 : 0;
+        barrier_wait(&done_barrier);
+    }
+    return NULL;
+}
+
+bool smp_is_running() {
+    return worker_count > 0;
+}
+
+void smp_start(Scheduler* scheduler) {
+    if (!scheduler || scheduler->num_cpus < 2) return;
+    if (worker_count == scheduler->num_cpus - 1 && worker_scheduler == scheduler) return;
+    smp_stop();
+
+    int count = scheduler->num_cpus - 1;
+    // The calling thread joins both barriers and runs CPU 0 between them
+    barrier_init(&start_barrier, count + 1);
+    barrier_init(&done_barrier, count + 1);
+    stop_requested = 0;
+    worker_scheduler = scheduler;
+
+    for (int i = 0; i < count; i++) {
+        workers[i].scheduler = scheduler;
+        workers[i].cpu_id = i + 1;
+        workers[i].executed = 0;
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            printf("[ERROR] Failed to start worker thread for CPU %d\n", i + 1);
+            // Unwind the threads already waiting on the start barrier
+            start_barrier.count = i + 1;
+            worker_count = i;
+            smp_stop();
+            return;
+        }
+    }
+    worker_count = count;
+    printf("[SMP] Started %d worker thread(s)\n", worker_count);
+}
+
+void smp_stop() {
+    if (worker_count == 0) return;
+    stop_requested = 1;
+    barrier_wait(&start_barrier);
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    barrier_destroy(&start_barrier);
+    barrier_destroy(&done_barrier);
+    printf("[SMP] Stopped %d worker thread(s)\n", worker_count);
+    worker_count = 0;
+    worker_scheduler = NULL;
+    stop_requested = 0;
+}
+
+// After fork() only the calling thread exists in the child; drop the parent's
+// workers without joining them. The next parallel cycle starts fresh ones.
+void smp_abandon() {
+    worker_count = 0;
+    worker_scheduler = NULL;
+    stop_requested = 0;
+}
+
+// Run one clock cycle on every CPU concurrently; returns how many CPUs executed an instruction
+int smp_run_cycle(Scheduler* scheduler) {
+    smp_start(scheduler);
+    if (worker_count == 0) return 0;
+
+    barrier_wait(&start_barrier);
+    int executed = cpu_step(scheduler, &scheduler->cpus[0]) ? 1 : 0;
+    barrier_wait(&done_barrier);
+
+    for (int i = 0; i < worker_count; i++) {
+        executed += workers[i].executed;
+    }
+    return executed;
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "timer.h"
+
+#define SLOT_MASK (TIMER_SLOTS - 1)
+
+// Timers are armed from CPU threads and expired by the clock
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static Timer* wheel[TIMER_LEVELS][TIMER_SLOTS];   // doubly linked lists, NULL = empty
+static int level_count[TIMER_LEVELS];
+static int wheel_clock = 0;                       // last cycle the wheel has processed
+static int slot_min[TIMER_LEVELS][TIMER_SLOTS];   // earliest expiry in a slot, if slot_min_valid
+static bool slot_min_valid[TIMER_LEVELS][TIMER_SLOTS];
+
+// Cycles covered by one slot of level
+static int slot_span(int level) {
+    return 1 << (TIMER_SLOT_BITS * level);
+}
+
+static void link_timer(Timer* timer, int level, int slot) {
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = wheel[level][slot];
+    if (timer->next) timer->next->prev = timer;
+    wheel[level][slot] = timer;
+    level_count[level]++;
+    if (!timer->next) {
+        slot_min[level][slot] = timer->expires;
+        slot_min_valid[level][slot] = true;
+    } else if (slot_min_valid[level][slot] && timer->expires < slot_min[level][slot]) {
+        slot_min[level][slot] = timer->expires;
+    }
+}
+
+static void unlink_timer(Timer* timer) {
+    if (timer->prev) timer->prev->next = timer->next;
+    else wheel[timer->level][timer->slot] = timer->next;
+    if (timer->next) timer->next->prev = timer->prev;
+    level_count[timer->level]--;
+    // Removing the earliest timer leaves the cached minimum stale; it is recomputed on demand
+    if (timer->expires == slot_min[timer->level][timer->slot]) slot_min_valid[timer->level][timer->slot] = false;
+    timer->level = -1;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+// File the timer by how far away it is; one already due goes in the next slot
+static void insert_timer(Timer* timer) {
+    int delta = timer->expires - wheel_clock;
+    if (delta <= 0) {
+        link_timer(timer, 0, (wheel_clock + 1) & SLOT_MASK);
+        return;
+    }
+    int level = 0;
+    while (level < TIMER_LEVELS - 1 && delta >= slot_span(level + 1)) level++;
+    link_timer(timer, level, (timer->expires >> (TIMER_SLOT_BITS * level)) & SLOT_MASK);
+}
+
+void timer_init(Timer* timer, void* owner) {
+    timer->expires = 0;
+    timer->kind = TIMER_NONE;
+    timer->owner = owner;
+    timer->level = -1;
+    timer->slot = -1;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+// (Re)arm to fire at cycle expires; delays beyond TIMER_MAX_DELAY are clamped
+void timer_arm(Timer* timer, int expires) {
+    if (!timer) return;
+    pthread_mutex_lock(&timer_lock);
+    if (timer->level >= 0) unlink_timer(timer);
+    if (expires - wheel_clock > TIMER_MAX_DELAY) {
+        printf("[WARN] Timer delay %d clamped to %d cycles\n", expires - wheel_clock, TIMER_MAX_DELAY);
+        expires = wheel_clock + TIMER_MAX_DELAY;
+    }
+    timer->expires = expires;
+    insert_timer(timer);
+    pthread_mutex_unlock(&timer_lock);
+}
+
+// False if it was not armed
+bool timer_cancel(Timer* timer) {
+    if (!timer) return false;
+    pthread_mutex_lock(&timer_lock);
+    bool armed = timer->level >= 0;
+    if (armed) unlink_timer(timer);
+    pthread_mutex_unlock(&timer_lock);
+    return armed;
+}
+
+bool timer_armed(const Timer* timer) {
+    return timer && timer->level >= 0;
+}
+
+// Move every timer of a slot onto the expired list (if due) or down the wheel
+static void cascade_slot(int level, int slot, Timer** expired) {
+    Timer* timer = wheel[level][slot];
+    while (timer) {
+        Timer* next = timer->next;
+        unlink_timer(timer);
+        if (timer->expires <= wheel_clock) {
+            timer->next = *expired;
+            *expired = timer;
+        } else {
+            insert_timer(timer);
+        }
+        timer = next;
+    }
+}
+
+// Run the wheel up to cycle now. Returns the expired timers, linked through next and
+// already disarmed; the caller acts on them. Stretches with nothing due in the lower
+// levels are skipped in one step, so long idle jumps cost nothing per cycle.
+Timer* timer_advance(int now) {
+    Timer* expired = NULL;
+    pthread_mutex_lock(&timer_lock);
+    while (wheel_clock < now) {
+        int lowest = 0;
+        while (lowest < TIMER_LEVELS && level_count[lowest] == 0) lowest++;
+        if (lowest == TIMER_LEVELS) {
+            wheel_clock = now;
+            break;
+        }
+        // Nothing below level lowest, so nothing happens before its next cascade point
+        int span = slot_span(lowest);
+        int next = lowest == 0 ? wheel_clock + 1 : (wheel_clock / span + 1) * span;
+        if (next > now) {
+            wheel_clock = now;
+            break;
+        }
+        wheel_clock = next;
+        if ((wheel_clock & SLOT_MASK) == 0) {
+            for (int level = 1; level < TIMER_LEVELS; level++) {
+                int slot = (wheel_clock >> (TIMER_SLOT_BITS * level)) & SLOT_MASK;
+                cascade_slot(level, slot, &expired);
+                if (slot != 0) break;
+            }
+        }
+        cascade_slot(0, wheel_clock & SLOT_MASK, &expired);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return expired;
+}
+
+// Earliest expiry among the timers of a non-empty slot
+static int earliest_in_slot(int level, int slot) {
+    if (!slot_min_valid[level][slot]) {
+        int earliest = wheel[level][slot]->expires;
+        for (Timer* timer = wheel[level][slot]->next; timer; timer = timer->next) {
+            if (timer->expires < earliest) earliest = timer->expires;
+        }
+        slot_min[level][slot] = earliest;
+        slot_min_valid[level][slot] = true;
+    }
+    return slot_min[level][slot];
+}
+
+// Earliest cycle at which a timer expires, -1 if nothing is armed. Within a coarse
+// level only the first non-empty slot can hold that level's earliest timer, and
+// each slot caches its minimum, so this is cheap even with many timers armed.
+int timer_next_expiry() {
+    int next = -1;
+    pthread_mutex_lock(&timer_lock);
+    if (level_count[0] > 0) {
+        for (int step = 1; step <= TIMER_SLOTS; step++) {
+            if (wheel[0][(wheel_clock + step) & SLOT_MASK]) {
+                next = wheel_clock + step;
+                break;
+            }
+        }
+    }
+    for (int level = 1; level < TIMER_LEVELS; level++) {
+        if (level_count[level] == 0) continue;
+        int span = slot_span(level);
+        int period = span << TIMER_SLOT_BITS;
+        int base = wheel_clock / period * period;
+        int first_at = -1, first_slot = -1;
+        for (int slot = 0; slot < TIMER_SLOTS; slot++) {
+            if (!wheel[level][slot]) continue;
+            int at = base + slot * span;
+            if (at <= wheel_clock) at += period;
+            if (first_at < 0 || at < first_at) {
+                first_at = at;
+                first_slot = slot;
+            }
+        }
+        int earliest = earliest_in_slot(level, first_slot);
+        if (next < 0 || earliest < next) next = earliest;
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return next;
+}
+
+int timer_count() {
+    pthread_mutex_lock(&timer_lock);
+    int count = 0;
+    for (int level = 0; level < TIMER_LEVELS; level++) count += level_count[level];
+    pthread_mutex_unlock(&timer_lock);
+    return count;
+}
+
+// Disarm everything and restart the wheel at cycle now
+void timer_reset(int now) {
+    pthread_mutex_lock(&timer_lock);
+    for (int level = 0; level < TIMER_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_SLOTS; slot++) {
+            while (wheel[level][slot]) unlink_timer(wheel[level][slot]);
+        }
+    }
+    wheel_clock = now;
+    pthread_mutex_unlock(&timer_lock);
+}
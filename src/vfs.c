@@ -0,0 +1,366 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "vfs.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define truncate_file(file, length) _chsize(_fileno(file), (long)(length))
+#else
+#include <unistd.h>
+#define truncate_file(file, length) ftruncate(fileno(file), (off_t)(length))
+#endif
+
+#define INITIAL_FILE_CAPACITY 16
+#define INITIAL_PATH_TABLE_SIZE 32   // power of two, kept at most half full
+
+// One file the simulation has read or written
+typedef struct {
+    char* path;
+    char* data;                  // full contents as they are, or will be, on disk
+    size_t length;
+    bool dirty;                  // newer than the disk copy
+    FILE* handle;                // cached write handle, NULL when closed
+    unsigned long long last_used;
+} VfsFile;
+
+// readFile/writeFile run on every CPU thread during parallel execution
+static pthread_mutex_t vfs_lock = PTHREAD_MUTEX_INITIALIZER;
+static VfsMode vfs_mode = VFS_WRITE_THROUGH;
+static VfsFile* files = NULL;
+static int file_count = 0;
+static int file_capacity = 0;
+static int* path_table = NULL;   // open addressing: path hash -> index into files, -1 = empty
+static int path_table_size = 0;
+static int open_handles = 0;
+static unsigned long long use_clock = 0;
+static size_t dirty_bytes = 0;
+static VfsStats stats;
+
+// FNV-1a
+static uint32_t hash_path(const char* path) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int path_slot(const char* path) {
+    int mask = path_table_size - 1;
+    int slot = (int)(hash_path(path) & (uint32_t)mask);
+    while (path_table[slot] != -1 && strcmp(files[path_table[slot]].path, path) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void grow_path_table() {
+    int new_size = path_table_size ? path_table_size * 2 : INITIAL_PATH_TABLE_SIZE;
+    int* new_table = malloc(new_size * sizeof(int));
+    if (!new_table) {
+        fprintf(stderr, "Failed to grow file table!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < new_size; i++) new_table[i] = -1;
+    free(path_table);
+    path_table = new_table;
+    path_table_size = new_size;
+    for (int i = 0; i < file_count; i++) {
+        path_table[path_slot(files[i].path)] = i;
+    }
+}
+
+static VfsFile* find_file(const char* path) {
+    if (!path_table) return NULL;
+    int index = path_table[path_slot(path)];
+    return index >= 0 ? &files[index] : NULL;
+}
+
+static VfsFile* add_file(const char* path) {
+    if (file_count == file_capacity) {
+        int capacity = file_capacity ? file_capacity * 2 : INITIAL_FILE_CAPACITY;
+        VfsFile* grown = realloc(files, capacity * sizeof(VfsFile));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow file table!\n");
+            exit(EXIT_FAILURE);
+        }
+        files = grown;
+        file_capacity = capacity;
+    }
+    if ((file_count + 1) * 2 > path_table_size) grow_path_table();
+
+    VfsFile* file = &files[file_count];
+    file->path = strdup(path);
+    file->data = NULL;
+    file->length = 0;
+    file->dirty = false;
+    file->handle = NULL;
+    file->last_used = 0;
+    path_table[path_slot(path)] = file_count++;
+    return file;
+}
+
+static void close_handle(VfsFile* file) {
+    if (!file->handle) return;
+    fclose(file->handle);
+    file->handle = NULL;
+    open_handles--;
+}
+
+// Write handle for file, closing the least recently used one if the cache is full
+static FILE* get_handle(VfsFile* file) {
+    if (file->handle) return file->handle;
+    if (open_handles >= VFS_MAX_OPEN_HANDLES) {
+        VfsFile* victim = NULL;
+        for (int i = 0; i < file_count; i++) {
+            if (files[i].handle && (!victim || files[i].last_used < victim->last_used)) {
+                victim = &files[i];
+            }
+        }
+        if (victim) close_handle(victim);
+    }
+    file->handle = fopen(file->path, "wb");
+    stats.opens++;
+    if (!file->handle) {
+        printf("[ERROR] Cannot open [%s] for writing\n", file->path);
+        return NULL;
+    }
+    open_handles++;
+    return file->handle;
+}
+
+// Rewrite the whole file through its cached handle
+static bool write_to_disk(VfsFile* file) {
+    FILE* handle = get_handle(file);
+    if (!handle) return false;
+    rewind(handle);
+    bool ok = fwrite(file->data, 1, file->length, handle) == file->length &&
+              fflush(handle) == 0 &&
+              truncate_file(handle, file->length) == 0;
+    stats.disk_writes++;
+    if (!ok) {
+        printf("[ERROR] Failed writing [%s]\n", file->path);
+        close_handle(file);
+        return false;
+    }
+    if (file->dirty) {
+        file->dirty = false;
+        dirty_bytes -= file->length < dirty_bytes ? file->length : dirty_bytes;
+    }
+    return true;
+}
+
+static bool load_from_disk(VfsFile** out, const char* path) {
+    FILE* disk = fopen(path, "rb");
+    stats.opens++;
+    if (!disk) return false;
+    size_t capacity = 256, length = 0;
+    char* data = malloc(capacity);
+    size_t got;
+    while (data && (got = fread(data + length, 1, capacity - length - 1, disk)) > 0) {
+        length += got;
+        if (capacity - length - 1 == 0) {
+            capacity *= 2;
+            char* grown = realloc(data, capacity);
+            if (!grown) free(data);
+            data = grown;
+        }
+    }
+    fclose(disk);
+    if (!data) return false;
+    data[length] = '\0';
+    stats.disk_reads++;
+
+    VfsFile* file = find_file(path);
+    if (!file) file = add_file(path);
+    free(file->data);
+    file->data = data;
+    file->length = length;
+    *out = file;
+    return true;
+}
+
+static int flush_locked() {
+    int written = 0;
+    for (int i = 0; i < file_count; i++) {
+        if (files[i].dirty && write_to_disk(&files[i])) written++;
+    }
+    return written;
+}
+
+void vfs_set_mode(VfsMode mode) {
+    if (mode < VFS_WRITE_THROUGH || mode > VFS_MEMORY) return;
+    pthread_mutex_lock(&vfs_lock);
+    // Leaving a buffered mode for write-through must not strand pending writes
+    if (mode == VFS_WRITE_THROUGH) flush_locked();
+    vfs_mode = mode;
+    pthread_mutex_unlock(&vfs_lock);
+    printf("[VFS] File mode set to %d\n", mode);
+}
+
+VfsMode vfs_get_mode() {
+    return vfs_mode;
+}
+
+// writeFile semantics: replace the file with data plus a newline
+bool vfs_write(const char* path, const char* data) {
+    if (!path || !data) return false;
+    size_t length = strlen(data);
+    char* contents = malloc(length + 2);
+    if (!contents) return false;
+    memcpy(contents, data, length);
+    contents[length] = '\n';
+    contents[length + 1] = '\0';
+
+    pthread_mutex_lock(&vfs_lock);
+    stats.writes++;
+    VfsFile* file = find_file(path);
+    if (!file) file = add_file(path);
+    if (file->dirty) dirty_bytes -= file->length < dirty_bytes ? file->length : dirty_bytes;
+    free(file->data);
+    file->data = contents;
+    file->length = length + 1;
+    file->last_used = ++use_clock;
+
+    bool ok = true;
+    if (vfs_mode == VFS_WRITE_THROUGH) {
+        ok = write_to_disk(file);
+    } else {
+        // Repeated writes to the same file coalesce into one disk write at flush time
+        file->dirty = true;
+        dirty_bytes += file->length;
+        if (vfs_mode == VFS_WRITE_BACK && dirty_bytes > VFS_WRITE_BACK_LIMIT) flush_locked();
+    }
+    pthread_mutex_unlock(&vfs_lock);
+    return ok;
+}
+
+// Whole contents without the trailing newline, as a heap string; NULL if the file does not exist
+char* vfs_read(const char* path) {
+    if (!path) return NULL;
+    pthread_mutex_lock(&vfs_lock);
+    stats.reads++;
+    VfsFile* file = find_file(path);
+    if (file && file->data) {
+        stats.cache_hits++;
+    } else if (!load_from_disk(&file, path)) {
+        pthread_mutex_unlock(&vfs_lock);
+        return NULL;
+    }
+    file->last_used = ++use_clock;
+
+    size_t length = file->length;
+    if (length > 0 && file->data[length - 1] == '\n') length--;
+    if (length > 0 && file->data[length - 1] == '\r') length--;
+    char* copy = malloc(length + 1);
+    if (copy) {
+        memcpy(copy, file->data, length);
+        copy[length] = '\0';
+    }
+    pthread_mutex_unlock(&vfs_lock);
+    return copy;
+}
+
+// Write every pending file to disk, whatever the mode; returns how many were written
+int vfs_flush() {
+    pthread_mutex_lock(&vfs_lock);
+    int written = flush_locked();
+    pthread_mutex_unlock(&vfs_lock);
+    if (written > 0) printf("[VFS] Flushed %d file(s)\n", written);
+    return written;
+}
+
+// End of a run: write-back files reach the disk, in-memory ones stay put
+void vfs_sync() {
+    if (vfs_mode == VFS_WRITE_BACK) vfs_flush();
+}
+
+// Forget every file; write-back data is flushed first, in-memory data is dropped
+void vfs_reset() {
+    pthread_mutex_lock(&vfs_lock);
+    if (vfs_mode == VFS_WRITE_BACK) flush_locked();
+    for (int i = 0; i < file_count; i++) {
+        close_handle(&files[i]);
+        free(files[i].path);
+        free(files[i].data);
+    }
+    file_count = 0;
+    for (int i = 0; i < path_table_size; i++) path_table[i] = -1;
+    dirty_bytes = 0;
+    memset(&stats, 0, sizeof(stats));
+    pthread_mutex_unlock(&vfs_lock);
+}
+
+VfsStats vfs_get_stats() {
+    pthread_mutex_lock(&vfs_lock);
+    VfsStats copy = stats;
+    pthread_mutex_unlock(&vfs_lock);
+    return copy;
+}
+
+// Copies of every cached file, dirty ones included; returns the count, -1 on allocation failure
+int vfs_snapshot(VfsFileImage** images) {
+    pthread_mutex_lock(&vfs_lock);
+    int count = 0;
+    VfsFileImage* copies = malloc((file_count > 0 ? file_count : 1) * sizeof(VfsFileImage));
+    for (int i = 0; copies && i < file_count; i++) {
+        if (!files[i].data) continue;
+        VfsFileImage* image = &copies[count];
+        image->path = strdup(files[i].path);
+        image->data = malloc(files[i].length + 1);
+        if (!image->path || !image->data) {
+            free(image->path);
+            free(image->data);
+            vfs_free_images(copies, count);
+            copies = NULL;
+            break;
+        }
+        memcpy(image->data, files[i].data, files[i].length + 1);
+        image->length = files[i].length;
+        image->dirty = files[i].dirty;
+        count++;
+    }
+    pthread_mutex_unlock(&vfs_lock);
+    *images = copies;
+    return copies ? count : -1;
+}
+
+void vfs_free_images(VfsFileImage* images, int count) {
+    if (!images) return;
+    for (int i = 0; i < count; i++) {
+        free(images[i].path);
+        free(images[i].data);
+    }
+    free(images);
+}
+
+// Replace the cache with a checkpoint's files. Unflushed data of the run being
+// replaced is dropped, not written. Takes over each image's data buffer.
+void vfs_restore(VfsMode mode, const VfsStats* saved_stats, VfsFileImage* images, int count) {
+    pthread_mutex_lock(&vfs_lock);
+    for (int i = 0; i < file_count; i++) {
+        close_handle(&files[i]);
+        free(files[i].path);
+        free(files[i].data);
+    }
+    file_count = 0;
+    for (int i = 0; i < path_table_size; i++) path_table[i] = -1;
+    dirty_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        VfsFile* file = find_file(images[i].path);
+        if (!file) file = add_file(images[i].path);
+        free(file->data);
+        file->data = images[i].data;
+        file->length = images[i].length;
+        file->dirty = images[i].dirty;
+        if (file->dirty) dirty_bytes += file->length;
+        images[i].data = NULL;
+    }
+    vfs_mode = mode;
+    stats = *saved_stats;
+    pthread_mutex_unlock(&vfs_lock);
+}
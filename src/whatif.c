@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "whatif.h"
+#include "globals.h"
+#include "aio.h"
+#include "input.h"
+#include "smp.h"
+#include "events.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+// Branches are fork()ed children: program text and everything else the branch
+// never writes stays shared copy-on-write, and each branch only pays for the
+// pages it dirties. Results come back over one pipe per branch.
+
+static int processes_remaining(Scheduler* scheduler) {
+    int remaining = scheduler->blocked_queue.size + pending_list.count;
+    for (int c = 0; c < scheduler->num_cpus; c++) {
+        remaining += cpu_load(&scheduler->cpus[c]);
+    }
+    return remaining;
+}
+
+#ifndef _WIN32
+static void run_branch(Scheduler* scheduler, const WhatIfBranch* branch, int fd) {
+    smp_abandon();
+    aio_after_fork();
+    events_after_fork();
+    // Branch chatter would interleave with the parent's and every sibling's
+    if (!freopen("/dev/null", "w", stdout)) {
+        fclose(stdout);
+    }
+    // ...and its events would land in the parent's logs.txt
+    logger.log_file = NULL;
+
+    if (branch->algorithm >= FCFS && branch->algorithm <= CFS) {
+        set_scheduling_algorithm(scheduler, (SchedulingAlgorithm)branch->algorithm);
+    }
+    if (branch->quantum > 0) {
+        scheduler->quantum = branch->quantum;
+    }
+    if (branch->input_script[0]) {
+        input_load_script(branch->input_script);
+    }
+
+    int max_cycles = branch->max_cycles > 0 ? branch->max_cycles : WHATIF_DEFAULT_MAX_CYCLES;
+    int start = scheduler->clock_cycle;
+    while (processes_remaining(scheduler) > 0 && scheduler->clock_cycle - start < max_cycles) {
+        scheduler_step();
+    }
+
+    WhatIfResult result;
+    memset(&result, 0, sizeof(result));
+    result.ok = 1;
+    result.clock_cycle = scheduler->clock_cycle;
+    result.remaining = processes_remaining(scheduler);
+    result.finished = result.remaining == 0;
+    result.metrics = scheduler->metrics;
+
+    const char* out = (const char*)&result;
+    size_t left = sizeof(result);
+    while (left > 0) {
+        ssize_t written = write(fd, out, left);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        out += written;
+        left -= written;
+    }
+    close(fd);
+    _exit(0);
+}
+
+static bool read_result(int fd, WhatIfResult* result) {
+    char* in = (char*)result;
+    size_t left = sizeof(*result);
+    while (left > 0) {
+        ssize_t got = read(fd, in, left);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        in += got;
+        left -= got;
+    }
+    return true;
+}
+#endif
+
+int whatif_run(Scheduler* scheduler, const WhatIfBranch* branches, int count, WhatIfResult* results) {
+    if (!scheduler || !branches || !results || count <= 0) return 0;
+    if (count > WHATIF_MAX_BRANCHES) count = WHATIF_MAX_BRANCHES;
+    memset(results, 0, count * sizeof(WhatIfResult));
+
+#ifdef _WIN32
+    printf("[ERROR] What-if branches need fork(), which this platform does not have\n");
+    return 0;
+#else
+    pid_t children[WHATIF_MAX_BRANCHES];
+    int pipes[WHATIF_MAX_BRANCHES];
+
+    // Buffered output would otherwise be flushed once by every child as well
+    fflush(stdout);
+    fflush(stderr);
+    // Forked between clock cycles, when no worker thread holds any lock;
+    // the I/O threads are drained first so no file write is half done
+    aio_quiesce();
+    int started = 0;
+    for (int b = 0; b < count; b++) {
+        int fds[2];
+        children[b] = -1;
+        pipes[b] = -1;
+        if (pipe(fds) != 0) {
+            printf("[ERROR] pipe() failed for what-if branch %d\n", b);
+            continue;
+        }
+        pid_t child = fork();
+        if (child < 0) {
+            printf("[ERROR] fork() failed for what-if branch %d\n", b);
+            close(fds[0]);
+            close(fds[1]);
+            continue;
+        }
+        if (child == 0) {
+            close(fds[0]);
+            for (int i = 0; i < b; i++) {
+                if (pipes[i] >= 0) close(pipes[i]);
+            }
+            run_branch(scheduler, &branches[b], fds[1]);
+        }
+        close(fds[1]);
+        children[b] = child;
+        pipes[b] = fds[0];
+        started++;
+    }
+    printf("[WHATIF] Forked %d branch(es) at clock %d\n", started, scheduler->clock_cycle);
+
+    int reported = 0;
+    for (int b = 0; b < count; b++) {
+        if (children[b] < 0) continue;
+        if (read_result(pipes[b], &results[b])) {
+            reported++;
+        } else {
+            printf("[WARN] What-if branch %d exited without reporting\n", b);
+            results[b].ok = 0;
+        }
+        close(pipes[b]);
+        waitpid(children[b], NULL, 0);
+    }
+    return reported;
+#endif
+}